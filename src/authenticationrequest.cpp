@@ -16,6 +16,8 @@
 
 #include "authenticationrequest.h"
 #include "request_p.h"
+#include "requestscheduler_p.h"
+#include "tokenmanager_p.h"
 #include "urls.h"
 #include <QNetworkReply>
 #include <QStringList>
@@ -40,12 +42,17 @@ public:
         }
     
         Q_Q(AuthenticationRequest);
+        
+        RequestSchedulerPrivate::release(q);
     
         bool ok;
-        setResult(QtJson::Json::parse(reply->readAll(), ok));
+        const QString response = QString::fromUtf8(reply->readAll());
+        startParse();
+        setResult(QtJson::Json::parse(response, ok));
+        finishParse();
         
-        const QNetworkReply::NetworkError e = reply->error();
-        const QString es = reply->errorString();
+        const QNetworkReply::NetworkError e = replyError();
+        const QString es = replyErrorString();
         reply->deleteLater();
         reply = 0;
     
@@ -56,17 +63,28 @@ public:
             setStatus(Request::Canceled);
             setError(Request::NoError);
             setErrorString(QString());
-            emit q->finished();
+            finish();
             return;
         default:
             setStatus(Request::Failed);
             setError(Request::Error(e));
             setErrorString(es);
-            emit q->finished();
+            finish();
             return;
         }
     
         if (ok) {
+            const QVariantMap tokens = result.toMap();
+            
+            if (tokens.contains("access_token")) {
+                // Store the tokens, and allow the token manager to refresh the access token before it expires.
+                TokenManager::instance()->storeTokens(clientId, clientSecret, tokens.value("access_token").toString(),
+                                                      tokens.value("refresh_token").toString());
+                TokenManager::instance()->setExpiry(clientId, clientSecret, tokens.value("access_token").toString(),
+                                                    tokens.value("refresh_token").toString(),
+                                                    tokens.value("expires_in").toInt());
+            }
+            
             setStatus(Request::Ready);
             setError(Request::NoError);
             setErrorString(QString());
@@ -77,7 +95,7 @@ public:
             setErrorString(Request::tr("Unable to parse response"));
         }
     
-        emit q->finished();
+        finish();
     }
         
     QString redirectUri;
@@ -95,6 +113,10 @@ public:
     
     The AuthenticationRequest class is used for obtaining and revoking access tokens for use with the SoundCloud Data 
     API.
+    
+    The expiry of an access token obtained using exchangeCodeForAccessToken() is recorded, so that the token can be 
+    refreshed in the background shortly before it expires, as long as it is being used to make requests. If a 
+    TokenStore has been set, the tokens are also written to the store.
      
     For more details on SoundCloud authentication, see 
     <a target="_blank" href="https://developers.soundcloud.com/docs/api/reference">here</a>.
@@ -0,0 +1,752 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "client_p.h"
+#include "authenticationrequest.h"
+#include "resourcesrequest.h"
+#include "streamsrequest.h"
+#include "tokenmanager_p.h"
+#include <QEventLoop>
+#include <QNetworkAccessManager>
+#include <QThread>
+#ifdef QSOUNDCLOUD_DEBUG
+#include <QDebug>
+#endif
+
+namespace QSoundCloud {
+
+// Guards the link between a client and the data of its threads, which can be deleted from either side. It is
+// recursive because slots connected to the signals of the client can use the client while it is held.
+Q_GLOBAL_STATIC_WITH_ARGS(QMutex, threadDataMutex, (QMutex::Recursive))
+
+ClientThreadData::ClientThreadData(ClientPrivate *client) :
+    QObject(),
+    client(client),
+    manager(0)
+{
+}
+
+ClientThreadData::~ClientThreadData() {
+    QMutexLocker locker(threadDataMutex());
+    
+    if (client) {
+        client->threads.remove(thread());
+        client = 0;
+    }
+    
+    locker.unlock();
+    
+    // Futures that have not finished are finished with the status Canceled, so that nothing waits on them.
+    QMutableHashIterator<Request*, QFutureInterface<Result> > requestIterator(requests);
+    
+    while (requestIterator.hasNext()) {
+        requestIterator.next();
+        finishFuture(requestIterator.value(), Result(Request::Canceled));
+    }
+    
+    QMutableHashIterator<QFutureWatcher<Result>*, ClientWatch> watchIterator(watches);
+    
+    while (watchIterator.hasNext()) {
+        watchIterator.next();
+        delete watchIterator.value().continuation;
+        finishFuture(watchIterator.value().interface, Result(Request::Canceled));
+    }
+}
+
+QNetworkAccessManager* ClientThreadData::networkAccessManager() {
+    if (!manager) {
+        QMutexLocker locker(&client->mutex);
+        
+        if ((client->manager) && (client->manager->thread() == thread())) {
+            return client->manager;
+        }
+        
+        manager = new QNetworkAccessManager(this);
+    }
+    
+    return manager;
+}
+
+template <class T>
+T* ClientThreadData::request(QList<T*> &pool) {
+    T *r = (pool.isEmpty() ? 0 : pool.takeLast());
+    
+    if (!r) {
+        r = new T(this);
+        connect(r, SIGNAL(finished()), this, SLOT(_q_onRequestFinished()));
+    }
+    
+    r->setNetworkAccessManager(networkAccessManager());
+    client->configure(r);
+    return r;
+}
+
+AuthenticationRequest* ClientThreadData::authenticationRequest() {
+    AuthenticationRequest *r = request(authenticationPool);
+    QMutexLocker locker(&client->mutex);
+    r->setRedirectUri(client->redirectUri);
+    return r;
+}
+
+ResourcesRequest* ClientThreadData::resourcesRequest() {
+    return request(resourcesPool);
+}
+
+StreamsRequest* ClientThreadData::streamsRequest() {
+    return request(streamsPool);
+}
+
+QFuture<Result> ClientThreadData::start(Request *r) {
+    QFutureInterface<Result> interface;
+    interface.reportStarted();
+    requests[r] = interface;
+    return interface.future();
+}
+
+void ClientThreadData::watch(QFutureWatcher<Result> *watcher, const QFuture<Result> &future, const ClientWatch &w) {
+    if (!watcher) {
+        watcher = new QFutureWatcher<Result>(this);
+        connect(watcher, SIGNAL(finished()), this, SLOT(_q_onFutureFinished()));
+    }
+    
+    watches[watcher] = w;
+    watcher->setFuture(future);
+}
+
+void ClientThreadData::_q_onRequestFinished() {
+    Request *r = qobject_cast<Request*>(sender());
+    
+    if ((!r) || (!requests.contains(r))) {
+        return;
+    }
+    
+    QFutureInterface<Result> interface = requests.take(r);
+    const Result result(r->status(), r->result(), r->error(), r->errorString(), r->timings());
+    
+    if (AuthenticationRequest *authRequest = qobject_cast<AuthenticationRequest*>(r)) {
+        authenticationPool << authRequest;
+        
+        QMutexLocker locker(threadDataMutex());
+        
+        if ((client) && (result.isReady())) {
+            const QVariantMap token = result.result().toMap();
+            client->setTokens(token.value("access_token").toString(), token.value("refresh_token").toString());
+        }
+    }
+    else if (ResourcesRequest *resourcesRequest = qobject_cast<ResourcesRequest*>(r)) {
+        resourcesPool << resourcesRequest;
+    }
+    else if (StreamsRequest *streamsRequest = qobject_cast<StreamsRequest*>(r)) {
+        streamsPool << streamsRequest;
+    }
+    
+    finishFuture(interface, result);
+}
+
+void ClientThreadData::_q_onFutureFinished() {
+    QFutureWatcher<Result> *watcher = static_cast<QFutureWatcher<Result>*>(sender());
+    
+    if (!watches.contains(watcher)) {
+        return;
+    }
+    
+    ClientWatch w = watches.take(watcher);
+    const Result result = futureResult(watcher->future());
+    
+    if (w.continuation) {
+        if (!w.chained) {
+            w.chained = true;
+            watch(watcher, w.continuation->run(result), w);
+            return;
+        }
+        
+        delete w.continuation;
+        finishFuture(w.interface, result);
+    }
+    else {
+        if ((!result.isReady()) && (w.failure.status() == Request::Null)) {
+            w.failure = result;
+        }
+        
+        w.results << result.result();
+        
+        if (!w.futures.isEmpty()) {
+            watch(watcher, w.futures.takeFirst(), w);
+            return;
+        }
+        
+        if (w.failure.status() == Request::Null) {
+            finishFuture(w.interface, Result(Request::Ready, w.results));
+        }
+        else {
+            finishFuture(w.interface, Result(w.failure.status(), w.results, w.failure.error(),
+                                             w.failure.errorString()));
+        }
+    }
+    
+    watcher->deleteLater();
+}
+
+ClientPrivate::ClientPrivate(Client *parent) :
+    q_ptr(parent),
+    manager(0)
+{
+}
+
+ClientPrivate::~ClientPrivate() {
+    // The data of each thread is detached from the client, so that it is no longer used. Data that belongs to 
+    // another thread is deleted in that thread.
+    QMutexLocker locker(threadDataMutex());
+    const QList<ClientThreadData*> data = threads.values();
+    threads.clear();
+    
+    foreach (ClientThreadData *d, data) {
+        d->client = 0;
+    }
+    
+    locker.unlock();
+    
+    foreach (ClientThreadData *d, data) {
+        if (d->thread() == QThread::currentThread()) {
+            delete d;
+        }
+        else {
+            d->deleteLater();
+        }
+    }
+}
+
+ClientThreadData* ClientPrivate::threadData() {
+    QThread *thread = QThread::currentThread();
+    QMutexLocker locker(threadDataMutex());
+    ClientThreadData *data = threads.value(thread);
+    
+    if (!data) {
+        data = new ClientThreadData(this);
+        QObject::connect(thread, SIGNAL(finished()), data, SLOT(deleteLater()));
+        threads.insert(thread, data);
+    }
+    
+    return data;
+}
+
+void ClientPrivate::configure(Request *request) const {
+    QMutexLocker locker(&mutex);
+    request->setClientId(clientId);
+    request->setClientSecret(clientSecret);
+    request->setAccessToken(accessToken);
+    request->setRefreshToken(refreshToken);
+}
+
+void ClientPrivate::setTokens(const QString &access, const QString &refresh) {
+    Q_Q(Client);
+    
+    QMutexLocker locker(&mutex);
+    const bool accessChanged = (access != accessToken);
+    const bool refreshChanged = (refresh != refreshToken);
+    accessToken = access;
+    refreshToken = refresh;
+    locker.unlock();
+    
+    if (accessChanged) {
+        emit q->accessTokenChanged(access);
+    }
+    
+    if (refreshChanged) {
+        emit q->refreshTokenChanged(refresh);
+    }
+}
+
+void ClientPrivate::_q_onAccessTokenRefreshed(const QString &previousRefreshToken, const QString &access,
+                                              const QString &refresh) {
+    QMutexLocker locker(&mutex);
+    
+    if (previousRefreshToken != refreshToken) {
+        return;
+    }
+    
+    locker.unlock();
+    setTokens(access, refresh);
+}
+
+/*!
+    \class Client
+    \brief Makes requests to the SoundCloud Data API and returns their results as futures.
+    
+    \ingroup requests
+    
+    Client provides the operations of ResourcesRequest, StreamsRequest and AuthenticationRequest as methods that
+    return a QFuture<Result>, rather than reporting the result through a finished() signal. This makes it simple to
+    run several requests at the same time, and to run requests that depend on the result of another.
+    
+    Client keeps the requests it has created and reuses them for later calls, so no QObject is created for each
+    call once enough requests have been created for the number of calls in progress. An access token that is 
+    refreshed by any request is kept by the client and used for every later request.
+    
+    When the access token has expired, it is refreshed only once, however many requests find that it has expired.
+    The other requests wait for the refresh to finish, and are then made again with the new access token. This is
+    true of all requests made using the library, including those of other clients and models, which are all given
+    the new access token. If a TokenStore has been set, the client is given the stored credentials when it is 
+    created.
+    
+    Threads
+    
+    The methods of Client can be called from any thread, and a single Client can be shared by several threads. 
+    Each thread that uses the client has its own requests and its own QNetworkAccessManager, and so its own pool 
+    of connections. The requests are made, and the futures they return are finished, in the calling thread, which 
+    must therefore run an event loop. Continuations passed to then() are also run in the thread that called then(). 
+    The properties of the client are shared by all threads, and can be changed from any thread. A 
+    QNetworkAccessManager set using setNetworkAccessManager() is used only in its own thread. The client must not 
+    be deleted while calls made from other threads are in progress.
+    
+    Futures returned by Client always contain exactly one Result. execute() can be used to wait for a future where 
+    there is no event loop, such as in a command line program.
+    
+    then() runs a function when a future has finished, and returns a future for the request made by that function.
+    whenAll() returns a future that finishes when every one of a list of futures has finished.
+    
+    Example usage:
+    
+    \code
+    using namespace QSoundCloud;
+    
+    ...
+    
+    struct GetStreams
+    {
+        GetStreams(Client *client) : client(client) {}
+        
+        QFuture<Result> operator()(const Result &track) {
+            if (!track.isReady()) {
+                return Client::fromResult(track);
+            }
+            
+            return client->getStreams(track.result().toMap().value("id").toString());
+        }
+        
+        Client *client;
+    };
+    
+    ...
+    
+    Client *client = new Client(this);
+    client->setClientId(CLIENT_ID);
+    
+    QFutureWatcher<Result> *watcher = new QFutureWatcher<Result>(this);
+    connect(watcher, SIGNAL(finished()), this, SLOT(onStreamsReady()));
+    watcher->setFuture(client->then(client->get("/resolve", filters), GetStreams(client)));
+    \endcode
+    
+    \sa Result
+*/
+Client::Client(QObject *parent) :
+    QObject(parent),
+    d_ptr(new ClientPrivate(this))
+{
+    Q_D(Client);
+    
+    const QVariantMap tokens = TokenManager::instance()->storedTokens();
+    
+    if (!tokens.isEmpty()) {
+        d->clientId = tokens.value("clientId").toString();
+        d->clientSecret = tokens.value("clientSecret").toString();
+        d->accessToken = tokens.value("accessToken").toString();
+        d->refreshToken = tokens.value("refreshToken").toString();
+    }
+    
+    connect(TokenManager::instance(), SIGNAL(refreshed(QString, QString, QString)),
+            this, SLOT(_q_onAccessTokenRefreshed(QString, QString, QString)));
+}
+
+Client::~Client() {}
+
+/*!
+    \property QString Client::clientId
+    \brief The client id used when making requests to the SoundCloud Data API.
+    
+    \sa Request::clientId
+*/
+
+/*!
+    \fn void Client::clientIdChanged()
+    \brief Emitted when the clientId changes.
+*/
+QString Client::clientId() const {
+    Q_D(const Client);
+    
+    QMutexLocker locker(&d->mutex);
+    return d->clientId;
+}
+
+void Client::setClientId(const QString &id) {
+    Q_D(Client);
+    
+    QMutexLocker locker(&d->mutex);
+    
+    if (id != d->clientId) {
+        d->clientId = id;
+        locker.unlock();
+        emit clientIdChanged();
+    }
+}
+
+/*!
+    \property QString Client::clientSecret
+    \brief The client secret used when making requests to the SoundCloud Data API.
+    
+    \sa Request::clientSecret
+*/
+
+/*!
+    \fn void Client::clientSecretChanged()
+    \brief Emitted when the clientSecret changes.
+*/
+QString Client::clientSecret() const {
+    Q_D(const Client);
+    
+    QMutexLocker locker(&d->mutex);
+    return d->clientSecret;
+}
+
+void Client::setClientSecret(const QString &secret) {
+    Q_D(Client);
+    
+    QMutexLocker locker(&d->mutex);
+    
+    if (secret != d->clientSecret) {
+        d->clientSecret = secret;
+        locker.unlock();
+        emit clientSecretChanged();
+    }
+}
+
+/*!
+    \property QString Client::accessToken
+    \brief The access token used when making requests to the SoundCloud Data API.
+    
+    The access token is updated when it is refreshed by a request, or obtained by exchangeCodeForAccessToken().
+    
+    \sa Request::accessToken
+*/
+
+/*!
+    \fn void Client::accessTokenChanged()
+    \brief Emitted when the accessToken changes.
+*/
+QString Client::accessToken() const {
+    Q_D(const Client);
+    
+    QMutexLocker locker(&d->mutex);
+    return d->accessToken;
+}
+
+void Client::setAccessToken(const QString &token) {
+    Q_D(Client);
+    
+    QMutexLocker locker(&d->mutex);
+    
+    if (token != d->accessToken) {
+        d->accessToken = token;
+        locker.unlock();
+        emit accessTokenChanged(token);
+    }
+}
+
+/*!
+    \property QString Client::refreshToken
+    \brief The refresh token used when the accessToken needs to be refreshed.
+    
+    \sa Request::refreshToken
+*/
+
+/*!
+    \fn void Client::refreshTokenChanged()
+    \brief Emitted when the refreshToken changes.
+*/
+QString Client::refreshToken() const {
+    Q_D(const Client);
+    
+    QMutexLocker locker(&d->mutex);
+    return d->refreshToken;
+}
+
+void Client::setRefreshToken(const QString &token) {
+    Q_D(Client);
+    
+    QMutexLocker locker(&d->mutex);
+    
+    if (token != d->refreshToken) {
+        d->refreshToken = token;
+        locker.unlock();
+        emit refreshTokenChanged(token);
+    }
+}
+
+/*!
+    \property QString Client::redirectUri
+    \brief The redirect uri used by exchangeCodeForAccessToken().
+    
+    \sa AuthenticationRequest::redirectUri
+*/
+
+/*!
+    \fn void Client::redirectUriChanged()
+    \brief Emitted when the redirectUri changes.
+*/
+QString Client::redirectUri() const {
+    Q_D(const Client);
+    
+    QMutexLocker locker(&d->mutex);
+    return d->redirectUri;
+}
+
+void Client::setRedirectUri(const QString &uri) {
+    Q_D(Client);
+    
+    QMutexLocker locker(&d->mutex);
+    
+    if (uri != d->redirectUri) {
+        d->redirectUri = uri;
+        locker.unlock();
+        emit redirectUriChanged();
+    }
+}
+
+/*!
+    \brief Sets the QNetworkAccessManager instance to be used when making requests to the SoundCloud Data API.
+    
+    Client does not take ownership of \a manager.
+    
+    \a manager is used only by calls made from the thread it belongs to. If no QNetworkAccessManager is set, one 
+    will be created for each thread when required, and shared by all requests made from that thread.
+*/
+void Client::setNetworkAccessManager(QNetworkAccessManager *manager) {
+    Q_D(Client);
+    
+    QMutexLocker locker(&d->mutex);
+    d->manager = manager;
+}
+
+/*!
+    \brief Requests SoundCloud resource(s) from \a resourcePath.
+    
+    \sa ResourcesRequest::get()
+*/
+QFuture<Result> Client::get(const QString &resourcePath, const QVariantMap &filters) {
+    Q_D(Client);
+    
+    ClientThreadData *data = d->threadData();
+    ResourcesRequest *request = data->resourcesRequest();
+    QFuture<Result> future = data->start(request);
+    request->get(resourcePath, filters);
+    return future;
+}
+
+/*!
+    \brief Requests the next page of a collection from \a nextHref.
+    
+    \sa ResourcesRequest::getNext()
+*/
+QFuture<Result> Client::getNext(const QString &nextHref) {
+    Q_D(Client);
+    
+    ClientThreadData *data = d->threadData();
+    ResourcesRequest *request = data->resourcesRequest();
+    QFuture<Result> future = data->start(request);
+    request->getNext(nextHref);
+    return future;
+}
+
+/*!
+    \brief Inserts a SoundCloud resource into \a resourcePath using a PUT request.
+    
+    \sa ResourcesRequest::insert()
+*/
+QFuture<Result> Client::insert(const QString &resourcePath) {
+    Q_D(Client);
+    
+    ClientThreadData *data = d->threadData();
+    ResourcesRequest *request = data->resourcesRequest();
+    QFuture<Result> future = data->start(request);
+    request->insert(resourcePath);
+    return future;
+}
+
+/*!
+    \brief Inserts a new SoundCloud resource into \a resourcePath.
+    
+    \sa ResourcesRequest::insert()
+*/
+QFuture<Result> Client::insert(const QVariantMap &resource, const QString &resourcePath) {
+    Q_D(Client);
+    
+    ClientThreadData *data = d->threadData();
+    ResourcesRequest *request = data->resourcesRequest();
+    QFuture<Result> future = data->start(request);
+    request->insert(resource, resourcePath);
+    return future;
+}
+
+/*!
+    \brief Updates the SoundCloud resource at \a resourcePath.
+    
+    \sa ResourcesRequest::update()
+*/
+QFuture<Result> Client::update(const QString &resourcePath, const QVariantMap &resource) {
+    Q_D(Client);
+    
+    ClientThreadData *data = d->threadData();
+    ResourcesRequest *request = data->resourcesRequest();
+    QFuture<Result> future = data->start(request);
+    request->update(resourcePath, resource);
+    return future;
+}
+
+/*!
+    \brief Deletes the SoundCloud resource at \a resourcePath.
+    
+    \sa ResourcesRequest::del()
+*/
+QFuture<Result> Client::del(const QString &resourcePath) {
+    Q_D(Client);
+    
+    ClientThreadData *data = d->threadData();
+    ResourcesRequest *request = data->resourcesRequest();
+    QFuture<Result> future = data->start(request);
+    request->del(resourcePath);
+    return future;
+}
+
+/*!
+    \brief Requests a list of streams for the track identified by \a id.
+    
+    \sa StreamsRequest::get()
+*/
+QFuture<Result> Client::getStreams(const QString &id) {
+    Q_D(Client);
+    
+    ClientThreadData *data = d->threadData();
+    StreamsRequest *request = data->streamsRequest();
+    QFuture<Result> future = data->start(request);
+    request->get(id);
+    return future;
+}
+
+/*!
+    \brief Submits \a code in exchange for a SoundCloud access token.
+    
+    If the exchange succeeds, the accessToken and refreshToken of the client are set from the result.
+    
+    \sa AuthenticationRequest::exchangeCodeForAccessToken()
+*/
+QFuture<Result> Client::exchangeCodeForAccessToken(const QString &code) {
+    Q_D(Client);
+    
+    ClientThreadData *data = d->threadData();
+    AuthenticationRequest *request = data->authenticationRequest();
+    QFuture<Result> future = data->start(request);
+    request->exchangeCodeForAccessToken(code);
+    return future;
+}
+
+/*!
+    \fn QFuture<Result> Client::then(const QFuture<Result> &future, Function function)
+    \brief Calls \a function with the result of \a future when it has finished.
+    
+    \a function must take a const Result& and return a QFuture<Result>, which is usually that of a request made
+    using the client. The future returned by then() finishes with the result of the future returned by \a function.
+    To finish without making another request, \a function can return a future created using fromResult().
+    
+    \a function is called in the thread that called then().
+*/
+QFuture<Result> Client::addContinuation(const QFuture<Result> &future, ClientContinuation *continuation) {
+    Q_D(Client);
+    
+    ClientWatch w;
+    w.continuation = continuation;
+    w.interface.reportStarted();
+    QFuture<Result> result = w.interface.future();
+    d->threadData()->watch(0, future, w);
+    return result;
+}
+
+/*!
+    \brief Returns a future that finishes when all of \a futures have finished.
+    
+    The result is a list containing the result of each future, in the same order as \a futures. If every future
+    finished with the status Ready, the status is Ready. Otherwise, the status and error are those of the first
+    future in \a futures that did not.
+*/
+QFuture<Result> Client::whenAll(const QList< QFuture<Result> > &futures) {
+    if (futures.isEmpty()) {
+        return fromResult(Result(Request::Ready, QVariantList()));
+    }
+    
+    Q_D(Client);
+    
+    ClientWatch w;
+    w.futures = futures;
+    w.interface.reportStarted();
+    QFuture<Result> result = w.interface.future();
+    const QFuture<Result> first = w.futures.takeFirst();
+    d->threadData()->watch(0, first, w);
+    return result;
+}
+
+/*!
+    \brief Returns a future that has already finished with \a result.
+*/
+QFuture<Result> Client::fromResult(const Result &result) {
+    QFutureInterface<Result> interface;
+    interface.reportStarted();
+    finishFuture(interface, result);
+    return interface.future();
+}
+
+/*!
+    \brief Waits for \a future to finish, and returns its result.
+    
+    The calling thread is blocked until \a future has finished, while its events continue to be processed by a 
+    local event loop, so that requests made from the calling thread can progress. This makes it possible to use 
+    Client in programs and worker threads that do not otherwise run an event loop. Since each thread has its own 
+    requests, execute() can be called from several threads at the same time.
+    
+    \code
+    Client client;
+    client.setClientId(CLIENT_ID);
+    Result result = Client::execute(client.get("/tracks", filters));
+    
+    if (result.isReady()) {
+        qDebug() << result.result();
+    }
+    \endcode
+*/
+Result Client::execute(const QFuture<Result> &future) {
+    if (!future.isFinished()) {
+        QEventLoop loop;
+        QFutureWatcher<Result> watcher;
+        connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+        watcher.setFuture(future);
+        loop.exec();
+    }
+    
+    return futureResult(future);
+}
+
+}
+
+#include "moc_client.cpp"
+#include "moc_client_p.cpp"
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QSOUNDCLOUD_CLIENT_H
+#define QSOUNDCLOUD_CLIENT_H
+
+#include "result.h"
+#include <QFuture>
+#include <QList>
+
+namespace QSoundCloud {
+
+class ClientPrivate;
+
+class ClientContinuation
+{
+
+public:
+    virtual ~ClientContinuation() {}
+    
+    virtual QFuture<Result> run(const Result &result) = 0;
+};
+
+template <typename Function>
+class ClientFunctionContinuation : public ClientContinuation
+{
+
+public:
+    explicit ClientFunctionContinuation(Function function) :
+        m_function(function)
+    {
+    }
+    
+    QFuture<Result> run(const Result &result) {
+        return m_function(result);
+    }
+
+private:
+    Function m_function;
+};
+
+class QSOUNDCLOUDSHARED_EXPORT Client : public QObject
+{
+    Q_OBJECT
+    
+    Q_PROPERTY(QString clientId READ clientId WRITE setClientId NOTIFY clientIdChanged)
+    Q_PROPERTY(QString clientSecret READ clientSecret WRITE setClientSecret NOTIFY clientSecretChanged)
+    Q_PROPERTY(QString accessToken READ accessToken WRITE setAccessToken NOTIFY accessTokenChanged)
+    Q_PROPERTY(QString refreshToken READ refreshToken WRITE setRefreshToken NOTIFY refreshTokenChanged)
+    Q_PROPERTY(QString redirectUri READ redirectUri WRITE setRedirectUri NOTIFY redirectUriChanged)
+
+public:
+    explicit Client(QObject *parent = 0);
+    ~Client();
+    
+    QString clientId() const;
+    void setClientId(const QString &id);
+    
+    QString clientSecret() const;
+    void setClientSecret(const QString &secret);
+    
+    QString accessToken() const;
+    void setAccessToken(const QString &token);
+    
+    QString refreshToken() const;
+    void setRefreshToken(const QString &token);
+    
+    QString redirectUri() const;
+    void setRedirectUri(const QString &uri);
+    
+    void setNetworkAccessManager(QNetworkAccessManager *manager);
+    
+    QFuture<Result> get(const QString &resourcePath, const QVariantMap &filters = QVariantMap());
+    QFuture<Result> getNext(const QString &nextHref);
+    
+    QFuture<Result> insert(const QString &resourcePath);
+    QFuture<Result> insert(const QVariantMap &resource, const QString &resourcePath);
+    
+    QFuture<Result> update(const QString &resourcePath, const QVariantMap &resource);
+    
+    QFuture<Result> del(const QString &resourcePath);
+    
+    QFuture<Result> getStreams(const QString &id);
+    
+    QFuture<Result> exchangeCodeForAccessToken(const QString &code);
+    
+    template <typename Function>
+    QFuture<Result> then(const QFuture<Result> &future, Function function) {
+        return addContinuation(future, new ClientFunctionContinuation<Function>(function));
+    }
+    
+    QFuture<Result> whenAll(const QList< QFuture<Result> > &futures);
+    
+    static QFuture<Result> fromResult(const Result &result);
+    
+    static Result execute(const QFuture<Result> &future);
+
+Q_SIGNALS:
+    void clientIdChanged();
+    void clientSecretChanged();
+    void accessTokenChanged(const QString &token);
+    void refreshTokenChanged(const QString &token);
+    void redirectUriChanged();
+
+private:
+    QFuture<Result> addContinuation(const QFuture<Result> &future, ClientContinuation *continuation);
+    
+    QScopedPointer<ClientPrivate> d_ptr;
+    
+    Q_DECLARE_PRIVATE(Client)
+    Q_DISABLE_COPY(Client)
+    
+    Q_PRIVATE_SLOT(d_func(), void _q_onAccessTokenRefreshed(QString, QString, QString))
+};
+
+}
+
+#endif // QSOUNDCLOUD_CLIENT_H
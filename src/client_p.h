@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QSOUNDCLOUD_CLIENT_P_H
+#define QSOUNDCLOUD_CLIENT_P_H
+
+#include "client.h"
+#include <QFutureInterface>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QMutex>
+
+class QThread;
+
+namespace QSoundCloud {
+
+class AuthenticationRequest;
+class ClientPrivate;
+class ResourcesRequest;
+class StreamsRequest;
+
+inline Result futureResult(const QFuture<Result> &future) {
+    return future.resultCount() > 0 ? future.resultAt(0) : Result(Request::Canceled);
+}
+
+inline void finishFuture(QFutureInterface<Result> &interface, const Result &result) {
+    interface.reportResult(result);
+    interface.reportFinished();
+}
+
+class ClientWatch
+{
+
+public:
+    ClientWatch() :
+        continuation(0),
+        chained(false)
+    {
+    }
+    
+    ClientContinuation *continuation;
+    bool chained;
+    
+    QList< QFuture<Result> > futures;
+    QVariantList results;
+    Result failure;
+    
+    QFutureInterface<Result> interface;
+};
+
+class ClientThreadData : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ClientThreadData(ClientPrivate *client);
+    ~ClientThreadData();
+    
+    QNetworkAccessManager* networkAccessManager();
+    
+    AuthenticationRequest* authenticationRequest();
+    ResourcesRequest* resourcesRequest();
+    StreamsRequest* streamsRequest();
+    
+    QFuture<Result> start(Request *request);
+    
+    void watch(QFutureWatcher<Result> *watcher, const QFuture<Result> &future, const ClientWatch &w);
+
+private Q_SLOTS:
+    void _q_onRequestFinished();
+    void _q_onFutureFinished();
+
+private:
+    template <class T>
+    T* request(QList<T*> &pool);
+    
+    ClientPrivate *client;
+    
+    QNetworkAccessManager *manager;
+    
+    QList<AuthenticationRequest*> authenticationPool;
+    QList<ResourcesRequest*> resourcesPool;
+    QList<StreamsRequest*> streamsPool;
+    
+    QHash<Request*, QFutureInterface<Result> > requests;
+    QHash<QFutureWatcher<Result>*, ClientWatch> watches;
+    
+    friend class ClientPrivate;
+};
+
+class ClientPrivate
+{
+
+public:
+    ClientPrivate(Client *parent);
+    ~ClientPrivate();
+    
+    ClientThreadData* threadData();
+    
+    void configure(Request *request) const;
+    
+    void setTokens(const QString &access, const QString &refresh);
+    
+    void _q_onAccessTokenRefreshed(const QString &previousRefreshToken, const QString &access,
+                                   const QString &refresh);
+    
+    Client *q_ptr;
+    
+    mutable QMutex mutex;
+    
+    QNetworkAccessManager *manager;
+    
+    QString clientId;
+    QString clientSecret;
+    QString accessToken;
+    QString refreshToken;
+    QString redirectUri;
+    
+    QHash<QThread*, ClientThreadData*> threads;
+    
+    Q_DECLARE_PUBLIC(Client)
+};
+
+}
+
+#endif // QSOUNDCLOUD_CLIENT_P_H
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QSOUNDCLOUD_COROUTINE_H
+#define QSOUNDCLOUD_COROUTINE_H
+
+#include "client.h"
+
+#if (QT_VERSION >= 0x050000) && defined(__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902L)
+#define QSOUNDCLOUD_COROUTINES
+
+#include <QFutureInterface>
+#include <QFutureWatcher>
+#include <coroutine>
+
+namespace QSoundCloud {
+
+/*!
+    \class Task
+    \brief The return type of a coroutine that makes requests using Client.
+    
+    \ingroup requests
+    
+    A coroutine returning Task finishes by co_return-ing a Result. The Task converts to a QFuture<Result>, so it can
+    be passed to Client::then() and Client::whenAll(), or awaited by another coroutine.
+    
+    Awaiting a QFuture<Result> suspends the coroutine without blocking the thread. The coroutine is resumed by the
+    event loop of the thread in which it was suspended, once the future has finished.
+    
+    These classes are available only when compiling with Qt 5 or later and a compiler that supports C++20
+    coroutines, in which case QSOUNDCLOUD_COROUTINES is defined.
+    
+    Example usage:
+    
+    \code
+    using namespace QSoundCloud;
+    
+    ...
+    
+    Task MyClass::getStreams(const QString &url) {
+        QVariantMap filters;
+        filters["url"] = url;
+        const Result track = co_await client->get("/resolve", filters);
+        
+        if (!track.isReady()) {
+            co_return track;
+        }
+        
+        co_return co_await client->getStreams(track.result().toMap().value("id").toString());
+    }
+    \endcode
+*/
+class Task
+{
+
+public:
+    class promise_type
+    {
+    
+    public:
+        Task get_return_object() {
+            interface.reportStarted();
+            return Task(interface.future());
+        }
+        
+        std::suspend_never initial_suspend() const noexcept { return std::suspend_never(); }
+        std::suspend_never final_suspend() const noexcept { return std::suspend_never(); }
+        
+        void return_value(const Result &result) {
+            interface.reportResult(result);
+            interface.reportFinished();
+        }
+        
+        void unhandled_exception() {
+            interface.reportResult(Result(Request::Failed, QVariant(), Request::UnknownContentError,
+                                          QLatin1String("Unhandled exception in coroutine")));
+            interface.reportFinished();
+        }
+    
+    private:
+        QFutureInterface<Result> interface;
+    };
+    
+    explicit Task(const QFuture<Result> &future) :
+        m_future(future)
+    {
+    }
+    
+    QFuture<Result> future() const {
+        return m_future;
+    }
+    
+    operator QFuture<Result>() const {
+        return m_future;
+    }
+
+private:
+    QFuture<Result> m_future;
+};
+
+class ResultAwaiter
+{
+
+public:
+    explicit ResultAwaiter(const QFuture<Result> &future) :
+        m_future(future)
+    {
+    }
+    
+    bool await_ready() const {
+        return m_future.isFinished();
+    }
+    
+    void await_suspend(std::coroutine_handle<> handle) {
+        QFutureWatcher<Result> *watcher = new QFutureWatcher<Result>;
+        QObject::connect(watcher, &QFutureWatcherBase::finished, watcher, [watcher, handle]() {
+            watcher->deleteLater();
+            handle.resume();
+        });
+        watcher->setFuture(m_future);
+    }
+    
+    Result await_resume() const {
+        return m_future.resultCount() > 0 ? m_future.resultAt(0) : Result(Request::Canceled);
+    }
+
+private:
+    QFuture<Result> m_future;
+};
+
+inline ResultAwaiter operator co_await(const QFuture<Result> &future) {
+    return ResultAwaiter(future);
+}
+
+inline ResultAwaiter operator co_await(const Task &task) {
+    return ResultAwaiter(task.future());
+}
+
+}
+
+#endif
+
+#endif // QSOUNDCLOUD_COROUTINE_H
@@ -0,0 +1,693 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "metrics_p.h"
+#include "request_p.h"
+#include <QAtomicInt>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QStringList>
+#include <QUrl>
+#include <qmath.h>
+#if QT_VERSION < 0x050300
+#include <QMutex>
+#endif
+
+namespace QSoundCloud {
+
+// Each power of two is divided into 8 buckets, so values are recorded to within 12.5%.
+static const int SUB_BUCKET_BITS = 3;
+static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+static const int HISTOGRAM_BUCKETS = SUB_BUCKETS * (32 - SUB_BUCKET_BITS);
+static const qint64 MAXIMUM_VALUE = 0x7FFFFFFF;
+// Further endpoints are recorded as "other", so that the number of metrics is bounded.
+static const int MAXIMUM_ENDPOINTS = 100;
+
+inline int atomicLoad(const QAtomicInt &value) {
+#if QT_VERSION >= 0x050000
+    return value.load();
+#else
+    return value;
+#endif
+}
+
+static int bucketIndex(qint64 value) {
+    if (value < SUB_BUCKETS) {
+        return int(value);
+    }
+    
+    value = qMin(value, MAXIMUM_VALUE);
+    int msb = SUB_BUCKET_BITS;
+    
+    while ((value >> (msb + 1)) > 0) {
+        msb++;
+    }
+    
+    const int shift = msb - SUB_BUCKET_BITS;
+    return SUB_BUCKETS + shift * SUB_BUCKETS + int((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+static qint64 bucketUpperBound(int index) {
+    if (index < SUB_BUCKETS) {
+        return index + 1;
+    }
+    
+    const int shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+    const int sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+    return qint64(SUB_BUCKETS + sub + 1) << shift;
+}
+
+class MetricCounter
+{
+
+public:
+    MetricCounter() :
+        m_value(0)
+    {
+    }
+    
+    void add(qint64 n) {
+#if QT_VERSION >= 0x050300
+        m_value.fetchAndAddRelaxed(n);
+#else
+        QMutexLocker locker(&m_mutex);
+        m_value += n;
+#endif
+    }
+    
+    qint64 value() const {
+#if QT_VERSION >= 0x050300
+        return m_value.load();
+#else
+        QMutexLocker locker(&m_mutex);
+        return m_value;
+#endif
+    }
+    
+    void reset() {
+#if QT_VERSION >= 0x050300
+        m_value.fetchAndStoreRelaxed(0);
+#else
+        QMutexLocker locker(&m_mutex);
+        m_value = 0;
+#endif
+    }
+
+private:
+#if QT_VERSION >= 0x050300
+    QAtomicInteger<qint64> m_value;
+#else
+    mutable QMutex m_mutex;
+    qint64 m_value;
+#endif
+};
+
+class MetricHistogram
+{
+
+public:
+    void record(qint64 value) {
+        if (value < 0) {
+            return;
+        }
+        
+        buckets[bucketIndex(value)].fetchAndAddRelaxed(1);
+        sum.add(value);
+        
+        const int v = int(qMin(value, MAXIMUM_VALUE));
+        int current = atomicLoad(maximum);
+        
+        while ((v > current) && (!maximum.testAndSetRelaxed(current, v))) {
+            current = atomicLoad(maximum);
+        }
+    }
+    
+    qint64 counts(int *c) const {
+        qint64 total = 0;
+        
+        for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+            c[i] = atomicLoad(buckets[i]);
+            total += c[i];
+        }
+        
+        return total;
+    }
+    
+    QVariantMap snapshot() const {
+        int c[HISTOGRAM_BUCKETS];
+        const qint64 total = counts(c);
+        const qint64 s = sum.value();
+        const qint64 max = atomicLoad(maximum);
+        QVariantMap map;
+        map["count"] = total;
+        map["sum"] = s;
+        map["max"] = max;
+        map["mean"] = (total > 0 ? qreal(s) / total : qreal(0));
+        map["p50"] = percentile(c, total, max, 0.5);
+        map["p90"] = percentile(c, total, max, 0.9);
+        map["p99"] = percentile(c, total, max, 0.99);
+        map["p999"] = percentile(c, total, max, 0.999);
+        return map;
+    }
+    
+    static qint64 percentile(const int *c, qint64 total, qint64 max, qreal q) {
+        if (total == 0) {
+            return 0;
+        }
+        
+        const qint64 rank = qMax(qint64(1), qint64(qCeil(q * total)));
+        qint64 cumulative = 0;
+        
+        for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+            cumulative += c[i];
+            
+            if (cumulative >= rank) {
+                return qMin(bucketUpperBound(i) - 1, max);
+            }
+        }
+        
+        return max;
+    }
+    
+    void reset() {
+        for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+            buckets[i].fetchAndStoreRelaxed(0);
+        }
+        
+        sum.reset();
+        maximum.fetchAndStoreRelaxed(0);
+    }
+    
+    QAtomicInt buckets[HISTOGRAM_BUCKETS];
+    
+    MetricCounter sum;
+    
+    QAtomicInt maximum;
+};
+
+class MetricsRegistry
+{
+
+public:
+    MetricsRegistry() :
+        enabled(1)
+    {
+    }
+    
+    ~MetricsRegistry() {
+        qDeleteAll(requests);
+        qDeleteAll(latencies);
+    }
+    
+    template <class T>
+    T* metric(QHash<QString, T*> &hash, const QString &key) {
+        {
+            QReadLocker locker(&lock);
+            
+            if (T *t = hash.value(key)) {
+                return t;
+            }
+        }
+        
+        QWriteLocker locker(&lock);
+        T *&t = hash[key];
+        
+        if (!t) {
+            t = new T;
+        }
+        
+        return t;
+    }
+    
+    QReadWriteLock lock;
+    
+    QAtomicInt enabled;
+    
+    QHash<QString, MetricCounter*> requests;
+    QHash<QString, MetricHistogram*> latencies;
+    
+    MetricHistogram queueTime;
+    MetricHistogram networkTime;
+    MetricHistogram parseTime;
+    MetricHistogram handlingTime;
+    
+    MetricCounter bytesSent;
+    MetricCounter bytesReceived;
+    MetricCounter retries;
+    MetricCounter redirects;
+    MetricCounter rateLimited;
+    MetricCounter tokenRefreshes[2];
+    MetricCounter cacheHits[2];
+    MetricCounter cacheMisses[2];
+};
+
+Q_GLOBAL_STATIC(MetricsRegistry, metricsRegistry)
+
+static QString endpoint(const QUrl &url) {
+    // Resource ids are replaced, so that requests for different resources are recorded under the same endpoint.
+    QStringList segments = url.path().split("/", QString::SkipEmptyParts);
+    
+    for (int i = 0; i < segments.size(); i++) {
+        bool ok;
+        segments.at(i).toLongLong(&ok);
+        
+        if (ok) {
+            segments[i] = ":id";
+        }
+    }
+    
+    return "/" + segments.join("/");
+}
+
+static QString statusName(Request::Status status) {
+    switch (status) {
+    case Request::Ready:
+        return "ready";
+    case Request::Failed:
+        return "failed";
+    case Request::Canceled:
+        return "canceled";
+    default:
+        return "unknown";
+    }
+}
+
+static QByteArray escapeLabel(const QString &value) {
+    QByteArray escaped = value.toUtf8();
+    escaped.replace("\\", "\\\\");
+    escaped.replace("\"", "\\\"");
+    escaped.replace("\n", "\\n");
+    return escaped;
+}
+
+static void appendCounter(QByteArray *out, const QByteArray &name, const QByteArray &help, qint64 value) {
+    *out += "# HELP " + name + " " + help + "\n";
+    *out += "# TYPE " + name + " counter\n";
+    *out += name + " " + QByteArray::number(value) + "\n";
+}
+
+static void appendHistogram(QByteArray *out, const QByteArray &name, const QByteArray &labels,
+                            const MetricHistogram &histogram) {
+    int c[HISTOGRAM_BUCKETS];
+    const qint64 total = histogram.counts(c);
+    const QByteArray prefix = (labels.isEmpty() ? QByteArray("{") : "{" + labels + ",");
+    int last = 0;
+    
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (c[i] > 0) {
+            last = i;
+        }
+    }
+    
+    // Bucket bounds fall on powers of two, so each power of two ends a bucket, and values are whole milliseconds.
+    qint64 cumulative = 0;
+    int index = 0;
+    
+    for (int k = 0; k < 32; k++) {
+        const qint64 bound = qint64(1) << k;
+        
+        while ((index < HISTOGRAM_BUCKETS) && (bucketUpperBound(index) <= bound)) {
+            cumulative += c[index++];
+        }
+        
+        *out += name + "_bucket" + prefix + "le=\"" + QByteArray::number(bound - 1) + "\"} "
+                + QByteArray::number(cumulative) + "\n";
+        
+        if (bound >= bucketUpperBound(last)) {
+            break;
+        }
+    }
+    
+    *out += name + "_bucket" + prefix + "le=\"+Inf\"} " + QByteArray::number(total) + "\n";
+    *out += name + "_sum" + (labels.isEmpty() ? QByteArray() : "{" + labels + "}") + " "
+            + QByteArray::number(histogram.sum.value()) + "\n";
+    *out += name + "_count" + (labels.isEmpty() ? QByteArray() : "{" + labels + "}") + " "
+            + QByteArray::number(total) + "\n";
+}
+
+void MetricsPrivate::recordRequest(const QUrl &url, Request::Operation operation, Request::Status status,
+                                   const RequestTimings &timings) {
+    MetricsRegistry *m = metricsRegistry();
+    
+    if (!atomicLoad(m->enabled)) {
+        return;
+    }
+    
+    QString e = endpoint(url);
+    
+    {
+        QReadLocker locker(&m->lock);
+        
+        if ((!m->latencies.contains(e)) && (m->latencies.size() >= MAXIMUM_ENDPOINTS)) {
+            e = "other";
+        }
+    }
+    
+    m->metric(m->requests, e + "\t" + RequestPrivate::methodName(operation) + "\t" + statusName(status))->add(1);
+    m->metric(m->latencies, e)->record(timings.totalTime());
+    
+    if ((timings.queued() > 0) && (timings.connectionStarted() > 0)) {
+        m->queueTime.record(timings.connectionStarted() - timings.queued());
+    }
+    
+    m->networkTime.record(timings.networkTime());
+    m->parseTime.record(timings.parseTime());
+    m->handlingTime.record(timings.handlingTime());
+    m->bytesSent.add(timings.bytesSent());
+    m->bytesReceived.add(timings.bytesReceived());
+    m->redirects.add(timings.redirects());
+}
+
+void MetricsPrivate::recordRetry() {
+    MetricsRegistry *m = metricsRegistry();
+    
+    if (atomicLoad(m->enabled)) {
+        m->retries.add(1);
+    }
+}
+
+void MetricsPrivate::recordRateLimited() {
+    MetricsRegistry *m = metricsRegistry();
+    
+    if (atomicLoad(m->enabled)) {
+        m->rateLimited.add(1);
+    }
+}
+
+void MetricsPrivate::recordTokenRefresh(bool succeeded) {
+    MetricsRegistry *m = metricsRegistry();
+    
+    if (atomicLoad(m->enabled)) {
+        m->tokenRefreshes[succeeded ? 0 : 1].add(1);
+    }
+}
+
+void MetricsPrivate::recordCache(Cache cache, bool hit) {
+    MetricsRegistry *m = metricsRegistry();
+    
+    if (atomicLoad(m->enabled)) {
+        (hit ? m->cacheHits[cache] : m->cacheMisses[cache]).add(1);
+    }
+}
+
+/*!
+    \class Metrics
+    \brief Collects statistics about every request made by the library.
+    
+    \ingroup requests
+    
+    Metrics records the following, and can return them as a snapshot(), as JSON using toJson(), or in the
+    Prometheus text format using toPrometheus():
+    
+    <table>
+        <tr>
+            <th>Metric</th>
+            <th>Description</th>
+        </tr>
+        <tr>
+            <td>requests</td>
+            <td>The number of requests finished, by endpoint, method and status.</td>
+        </tr>
+        <tr>
+            <td>latency</td>
+            <td>A histogram of the total time taken by requests, by endpoint.</td>
+        </tr>
+        <tr>
+            <td>queueTime</td>
+            <td>A histogram of the time from the start of each request until its last HTTP request was made,
+            including any time spent waiting for a slot, a rate limit or a retry.</td>
+        </tr>
+        <tr>
+            <td>networkTime</td>
+            <td>A histogram of the time taken by the last HTTP request of each request.</td>
+        </tr>
+        <tr>
+            <td>parseTime</td>
+            <td>A histogram of the time taken to parse responses.</td>
+        </tr>
+        <tr>
+            <td>handlingTime</td>
+            <td>A histogram of the time taken by the slots connected to Request::finished().</td>
+        </tr>
+        <tr>
+            <td>bytesSent, bytesReceived</td>
+            <td>The number of bytes in the bodies of HTTP requests and responses.</td>
+        </tr>
+        <tr>
+            <td>retries, redirects</td>
+            <td>The number of retries made and redirects followed.</td>
+        </tr>
+        <tr>
+            <td>rateLimited</td>
+            <td>The number of HTTP 429 (Too Many Requests) responses.</td>
+        </tr>
+        <tr>
+            <td>tokenRefreshes</td>
+            <td>The number of access token refreshes that succeeded and failed.</td>
+        </tr>
+        <tr>
+            <td>cache</td>
+            <td>The hits and misses of the cache set on the QNetworkAccessManager, and of the pages prefetched by
+            ResourcesModel.</td>
+        </tr>
+    </table>
+    
+    Times are in milliseconds. Endpoints are the paths of the requests, with resource ids replaced by ":id".
+    Histograms record each value to within 12.5%, and their snapshot includes the count, sum, mean, maximum and
+    the 50th, 90th, 99th and 99.9th percentiles.
+    
+    Counters and histograms are updated using atomic operations, so recording adds little overhead, even when
+    requests are made in many threads. A lock is taken only when an endpoint is first recorded.
+    
+    Example usage:
+    
+    \code
+    QFile file("metrics.prom");
+    
+    if (file.open(QFile::WriteOnly)) {
+        file.write(QSoundCloud::Metrics::toPrometheus());
+    }
+    \endcode
+    
+    \sa RequestTimings
+*/
+
+/*!
+    \brief Returns true if metrics are recorded.
+    
+    The default is true.
+*/
+bool Metrics::isEnabled() {
+    return atomicLoad(metricsRegistry()->enabled);
+}
+
+/*!
+    \brief Sets whether metrics are recorded to \a enabled.
+*/
+void Metrics::setEnabled(bool enabled) {
+    metricsRegistry()->enabled.fetchAndStoreRelaxed(enabled ? 1 : 0);
+}
+
+/*!
+    \brief Returns the current value of every metric.
+*/
+QVariantMap Metrics::snapshot() {
+    MetricsRegistry *m = metricsRegistry();
+    QVariantMap map;
+    QVariantList requests;
+    QVariantMap latency;
+    
+    {
+        QReadLocker locker(&m->lock);
+        QHashIterator<QString, MetricCounter*> iterator(m->requests);
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            const QStringList labels = iterator.key().split("\t");
+            QVariantMap request;
+            request["endpoint"] = labels.at(0);
+            request["method"] = labels.at(1);
+            request["status"] = labels.at(2);
+            request["count"] = iterator.value()->value();
+            requests << request;
+        }
+        
+        QHashIterator<QString, MetricHistogram*> latencies(m->latencies);
+        
+        while (latencies.hasNext()) {
+            latencies.next();
+            latency[latencies.key()] = latencies.value()->snapshot();
+        }
+    }
+    
+    map["requests"] = requests;
+    map["latency"] = latency;
+    map["queueTime"] = m->queueTime.snapshot();
+    map["networkTime"] = m->networkTime.snapshot();
+    map["parseTime"] = m->parseTime.snapshot();
+    map["handlingTime"] = m->handlingTime.snapshot();
+    map["bytesSent"] = m->bytesSent.value();
+    map["bytesReceived"] = m->bytesReceived.value();
+    map["retries"] = m->retries.value();
+    map["redirects"] = m->redirects.value();
+    map["rateLimited"] = m->rateLimited.value();
+    
+    QVariantMap refreshes;
+    refreshes["succeeded"] = m->tokenRefreshes[0].value();
+    refreshes["failed"] = m->tokenRefreshes[1].value();
+    map["tokenRefreshes"] = refreshes;
+    
+    QVariantMap cache;
+    const char *caches[] = { "http", "prefetch" };
+    
+    for (int i = MetricsPrivate::HttpCache; i <= MetricsPrivate::PrefetchCache; i++) {
+        const qint64 hits = m->cacheHits[i].value();
+        const qint64 misses = m->cacheMisses[i].value();
+        QVariantMap c;
+        c["hits"] = hits;
+        c["misses"] = misses;
+        c["hitRatio"] = (hits + misses > 0 ? qreal(hits) / (hits + misses) : qreal(0));
+        cache[caches[i]] = c;
+    }
+    
+    map["cache"] = cache;
+    return map;
+}
+
+/*!
+    \brief Returns the current value of every metric as JSON.
+    
+    \sa snapshot()
+*/
+QByteArray Metrics::toJson() {
+    return QtJson::Json::serialize(snapshot());
+}
+
+/*!
+    \brief Returns the current value of every metric in the Prometheus text exposition format.
+    
+    Histograms have a bucket for each power of two milliseconds, up to the largest value recorded.
+*/
+QByteArray Metrics::toPrometheus() {
+    MetricsRegistry *m = metricsRegistry();
+    QByteArray out;
+    
+    {
+        QReadLocker locker(&m->lock);
+        out += "# HELP qsoundcloud_requests_total The number of requests finished.\n";
+        out += "# TYPE qsoundcloud_requests_total counter\n";
+        QHashIterator<QString, MetricCounter*> iterator(m->requests);
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            const QStringList labels = iterator.key().split("\t");
+            out += "qsoundcloud_requests_total{endpoint=\"" + escapeLabel(labels.at(0)) + "\",method=\""
+                   + escapeLabel(labels.at(1)) + "\",status=\"" + escapeLabel(labels.at(2)) + "\"} "
+                   + QByteArray::number(iterator.value()->value()) + "\n";
+        }
+        
+        out += "# HELP qsoundcloud_request_duration_milliseconds The total time taken by requests.\n";
+        out += "# TYPE qsoundcloud_request_duration_milliseconds histogram\n";
+        QHashIterator<QString, MetricHistogram*> latencies(m->latencies);
+        
+        while (latencies.hasNext()) {
+            latencies.next();
+            appendHistogram(&out, "qsoundcloud_request_duration_milliseconds",
+                            "endpoint=\"" + escapeLabel(latencies.key()) + "\"", *latencies.value());
+        }
+    }
+    
+    const char *histograms[][2] = {
+        { "qsoundcloud_queue_duration_milliseconds", "The time until the last HTTP request of each request was made." },
+        { "qsoundcloud_network_duration_milliseconds", "The time taken by the last HTTP request of each request." },
+        { "qsoundcloud_parse_duration_milliseconds", "The time taken to parse responses." },
+        { "qsoundcloud_handling_duration_milliseconds", "The time taken by the slots connected to finished()." }
+    };
+    const MetricHistogram *values[] = { &m->queueTime, &m->networkTime, &m->parseTime, &m->handlingTime };
+    
+    for (int i = 0; i < 4; i++) {
+        const QByteArray name(histograms[i][0]);
+        out += "# HELP " + name + " " + histograms[i][1] + "\n";
+        out += "# TYPE " + name + " histogram\n";
+        appendHistogram(&out, name, QByteArray(), *values[i]);
+    }
+    
+    appendCounter(&out, "qsoundcloud_sent_bytes_total", "The number of bytes sent in request bodies.",
+                  m->bytesSent.value());
+    appendCounter(&out, "qsoundcloud_received_bytes_total", "The number of bytes received in response bodies.",
+                  m->bytesReceived.value());
+    appendCounter(&out, "qsoundcloud_retries_total", "The number of retries made.", m->retries.value());
+    appendCounter(&out, "qsoundcloud_redirects_total", "The number of redirects followed.", m->redirects.value());
+    appendCounter(&out, "qsoundcloud_rate_limited_total", "The number of HTTP 429 responses.",
+                  m->rateLimited.value());
+    
+    out += "# HELP qsoundcloud_token_refreshes_total The number of access token refreshes.\n";
+    out += "# TYPE qsoundcloud_token_refreshes_total counter\n";
+    out += "qsoundcloud_token_refreshes_total{result=\"succeeded\"} "
+           + QByteArray::number(m->tokenRefreshes[0].value()) + "\n";
+    out += "qsoundcloud_token_refreshes_total{result=\"failed\"} "
+           + QByteArray::number(m->tokenRefreshes[1].value()) + "\n";
+    
+    out += "# HELP qsoundcloud_cache_requests_total The number of cache lookups.\n";
+    out += "# TYPE qsoundcloud_cache_requests_total counter\n";
+    const char *caches[] = { "http", "prefetch" };
+    
+    for (int i = MetricsPrivate::HttpCache; i <= MetricsPrivate::PrefetchCache; i++) {
+        out += "qsoundcloud_cache_requests_total{cache=\"" + QByteArray(caches[i]) + "\",result=\"hit\"} "
+               + QByteArray::number(m->cacheHits[i].value()) + "\n";
+        out += "qsoundcloud_cache_requests_total{cache=\"" + QByteArray(caches[i]) + "\",result=\"miss\"} "
+               + QByteArray::number(m->cacheMisses[i].value()) + "\n";
+    }
+    
+    return out;
+}
+
+/*!
+    \brief Resets every metric to zero.
+*/
+void Metrics::reset() {
+    MetricsRegistry *m = metricsRegistry();
+    
+    {
+        QWriteLocker locker(&m->lock);
+        
+        foreach (MetricCounter *counter, m->requests) {
+            counter->reset();
+        }
+        
+        foreach (MetricHistogram *histogram, m->latencies) {
+            histogram->reset();
+        }
+    }
+    
+    m->queueTime.reset();
+    m->networkTime.reset();
+    m->parseTime.reset();
+    m->handlingTime.reset();
+    m->bytesSent.reset();
+    m->bytesReceived.reset();
+    m->retries.reset();
+    m->redirects.reset();
+    m->rateLimited.reset();
+    
+    for (int i = 0; i < 2; i++) {
+        m->tokenRefreshes[i].reset();
+        m->cacheHits[i].reset();
+        m->cacheMisses[i].reset();
+    }
+}
+
+}
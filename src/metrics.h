@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QSOUNDCLOUD_METRICS_H
+#define QSOUNDCLOUD_METRICS_H
+
+#include "qsoundcloud_global.h"
+#include <QVariantMap>
+
+namespace QSoundCloud {
+
+class QSOUNDCLOUDSHARED_EXPORT Metrics
+{
+
+public:
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+    
+    static QVariantMap snapshot();
+    
+    static QByteArray toJson();
+    static QByteArray toPrometheus();
+    
+    static void reset();
+};
+
+}
+
+#endif // QSOUNDCLOUD_METRICS_H
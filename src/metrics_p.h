@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QSOUNDCLOUD_METRICS_P_H
+#define QSOUNDCLOUD_METRICS_P_H
+
+#include "metrics.h"
+#include "request.h"
+
+class QUrl;
+
+namespace QSoundCloud {
+
+class MetricsPrivate
+{
+
+public:
+    enum Cache {
+        HttpCache = 0,
+        PrefetchCache
+    };
+    
+    static void recordRequest(const QUrl &url, Request::Operation operation, Request::Status status,
+                              const RequestTimings &timings);
+    static void recordRetry();
+    static void recordRateLimited();
+    static void recordTokenRefresh(bool succeeded);
+    static void recordCache(Cache cache, bool hit);
+};
+
+}
+
+#endif // QSOUNDCLOUD_METRICS_P_H
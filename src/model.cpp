@@ -15,9 +15,31 @@
  */
 
 #include "model_p.h"
+#include <algorithm>
 
 namespace QSoundCloud {
 
+static const quint8 VARIANT_CELL = 0xff;
+
+static ModelColumn::Type columnType(int type) {
+    switch (type) {
+    case QVariant::Invalid:
+        return ModelColumn::NullType;
+    case QVariant::Bool:
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+        return ModelColumn::IntegerType;
+    case QVariant::Double:
+        return ModelColumn::DoubleType;
+    case QVariant::String:
+        return ModelColumn::StringType;
+    default:
+        return ModelColumn::VariantType;
+    }
+}
+
 Model::Model(QObject *parent) :
     QAbstractListModel(parent),
     d_ptr(new ModelPrivate(this))
@@ -43,6 +65,9 @@ Model::~Model() {}
 #if QT_VERSION >= 0x050000
 /*!
     \brief The role names for use with QML.
+    
+    Unless a subclass defines a fixed set of roles, a role is added for each new key that appears in the items of 
+    the model, and roleNamesChanged() is emitted. Once assigned, the role of a key does not change.
 */
 QHash<int, QByteArray> Model::roleNames() const {
     Q_D(const Model);
@@ -61,13 +86,20 @@ QHash<int, QByteArray> Model::roleNames() const {
     \brief Emitted when items are added/removed.
 */
 
+/*!
+    \fn void Model::roleNamesChanged()
+    \brief Emitted when roles are added for new item keys.
+    
+    This is emitted before the rows containing the new keys are inserted.
+*/
+
 /*!
     \brief Returns the number of items in the model.
 */
 int Model::rowCount(const QModelIndex &) const {
     Q_D(const Model);
     
-    return d->items.size();
+    return d->count;
 }
 
 /*!
@@ -76,7 +108,16 @@ int Model::rowCount(const QModelIndex &) const {
 QVariant Model::data(const QModelIndex &index, int role) const {
     Q_D(const Model);
     
-    return get(index.row()).value(d->roles.value(role));
+    const int row = index.row();
+    
+    if ((row < 0) || (row >= d->count)) {
+        return QVariant();
+    }
+    
+    const_cast<ModelPrivate*>(d)->itemAccessed(row);
+    QHash<int, int>::const_iterator column = d->roleColumns.constFind(role);
+    
+    return column != d->roleColumns.constEnd() ? d->columnData.at(column.value()).value(row) : QVariant();
 }
 
 /*!
@@ -86,14 +127,14 @@ QMap<int, QVariant> Model::itemData(const QModelIndex &index) const {
     Q_D(const Model);
     
     QMap<int, QVariant> map;
-    QVariantMap item = get(index.row());
+    const int row = index.row();
     
-    if (!item.isEmpty()) {
-        QHashIterator<int, QByteArray> iterator(d->roles);
+    if ((row >= 0) && (row < d->count)) {
+        QHashIterator<int, int> iterator(d->roleColumns);
     
         while (iterator.hasNext()) {
             iterator.next();
-            map[iterator.key()] = item.value(iterator.value());
+            map[iterator.key()] = d->columnData.at(iterator.value()).value(row);
         }
     }
     
@@ -110,8 +151,18 @@ bool Model::setData(const QModelIndex &index, const QVariant &value, int role) {
     
     Q_D(Model);
     
-    d->items[index.row()][d->roles.value(role)] = value;
+    const int column = d->roleColumns.value(role, -1);
+    
+    if (column == -1) {
+        return false;
+    }
+    
+    d->setValue(index.row(), column, value);
+#if QT_VERSION >= 0x050000
+    emit dataChanged(index, index, QVector<int>() << role);
+#else
     emit dataChanged(index, index);
+#endif
     
     return true;
 }
@@ -127,13 +178,25 @@ bool Model::setItemData(const QModelIndex &index, const QMap<int, QVariant> &rol
     Q_D(Model);
     
     QMapIterator<int, QVariant> iterator(roles);
-    
+#if QT_VERSION >= 0x050000
+    QVector<int> changed;
+#endif
     while (iterator.hasNext()) {
         iterator.next();
-        d->items[index.row()][d->roles.value(iterator.key())] = iterator.value();
+        const int column = d->roleColumns.value(iterator.key(), -1);
+        
+        if (column != -1) {
+            d->setValue(index.row(), column, iterator.value());
+#if QT_VERSION >= 0x050000
+            changed << iterator.key();
+#endif
+        }
     }
-    
+#if QT_VERSION >= 0x050000
+    emit dataChanged(index, index, changed);
+#else
     emit dataChanged(index, index);
+#endif
     
     return true;
 }
@@ -149,13 +212,14 @@ void Model::append(const QMap<int, QVariant> &roles) {
     
     while (iterator.hasNext()) {
         iterator.next();
-        item[d->roles.value(iterator.key())] = iterator.value();
+        const int column = d->roleColumns.value(iterator.key(), -1);
+        
+        if (column != -1) {
+            item[d->keys.at(column)] = iterator.value();
+        }
     }
     
-    beginInsertRows(QModelIndex(), d->items.size(), d->items.size());
-    d->items << item;
-    endInsertRows();
-    emit countChanged(rowCount());
+    d->appendRows(QList<QVariantMap>() << item);
 }
 
 /*!
@@ -176,13 +240,14 @@ void Model::insert(const QModelIndex &index, const QMap<int, QVariant> &roles) {
     
     while (iterator.hasNext()) {
         iterator.next();
-        item[d->roles.value(iterator.key())] = iterator.value();
+        const int column = d->roleColumns.value(iterator.key(), -1);
+        
+        if (column != -1) {
+            item[d->keys.at(column)] = iterator.value();
+        }
     }
     
-    beginInsertRows(QModelIndex(), index.row(), index.row());
-    d->items.insert(index.row(), item);
-    endInsertRows();
-    emit countChanged(rowCount());
+    d->insertRows(index.row(), QList<QVariantMap>() << item);
 }
 
 /*!
@@ -195,14 +260,7 @@ bool Model::remove(const QModelIndex &index) {
         return false;
     }
     
-    Q_D(Model);
-    
-    beginRemoveRows(QModelIndex(), index.row(), index.row());
-    d->items.removeAt(index.row());
-    endRemoveRows();
-    emit countChanged(rowCount());
-    
-    return true;
+    return removeRows(index.row(), 1);
 }
 
 /*!
@@ -211,24 +269,28 @@ bool Model::remove(const QModelIndex &index) {
 QVariantMap Model::get(int row) const {
     Q_D(const Model);
     
-    return (row >= 0) && (row < d->items.size()) ? d->items.at(row) : QVariantMap();
+    return d->item(row);
 }
 
 /*!
     \brief Sets the \a property of the item at \a row to \a value.
     
+    The dataChanged() signal is not emitted immediately. Changes made during the same event loop iteration are 
+    merged and reported once for each range of adjacent rows, together with the roles that changed.
+    
     Returns true if successful.
 */
 bool Model::setProperty(int row, const QString &property, const QVariant &value) {
     Q_D(Model);
     
-    if ((row < 0) || (row >= d->items.size())) {
+    if ((row < 0) || (row >= d->count)) {
         return false;
     }
     
-    d->items[row][property] = value;
-    QModelIndex i = index(row);
-    emit dataChanged(i, i);
+    const int column = d->addColumn(property);
+    d->emitRoleNamesChanged();
+    d->setValue(row, column, value);
+    d->dataChanged(row, column);
     
     return true;
 }
@@ -236,12 +298,14 @@ bool Model::setProperty(int row, const QString &property, const QVariant &value)
 /*!
     \brief Sets the \a properties of the item at \a row to \a properties.
     
+    As with setProperty(), the dataChanged() signal is emitted on the next event loop iteration.
+    
     Returns true if successful.
 */
 bool Model::set(int row, const QVariantMap &properties) {
     Q_D(Model);
     
-    if ((row < 0) || (row >= d->items.size())) {
+    if ((row < 0) || (row >= d->count)) {
         return false;
     }
     
@@ -249,11 +313,12 @@ bool Model::set(int row, const QVariantMap &properties) {
     
     while (iterator.hasNext()) {
         iterator.next();
-        d->items[row][iterator.key()] = iterator.value();
+        const int column = d->addColumn(iterator.key());
+        d->setValue(row, column, iterator.value());
+        d->dataChanged(row, column);
     }
     
-    QModelIndex i = index(row);
-    emit dataChanged(i, i);
+    d->emitRoleNamesChanged();
     
     return true;
 }
@@ -262,16 +327,7 @@ bool Model::set(int row, const QVariantMap &properties) {
     \brief Appends an item to the model using \a properties.
 */
 void Model::append(const QVariantMap &properties) {
-    Q_D(Model);
-    
-    if (d->items.isEmpty()) {
-        d->setRoleNames(properties);
-    }
-    
-    beginInsertRows(QModelIndex(), d->items.size(), d->items.size());
-    d->items << properties;
-    endInsertRows();
-    emit countChanged(rowCount());
+    appendRows(QList<QVariantMap>() << properties);
 }
 
 /*!
@@ -280,59 +336,146 @@ void Model::append(const QVariantMap &properties) {
     If \a row is out of range, the item is appended.
 */
 void Model::insert(int row, const QVariantMap &properties) {
-    Q_D(Model);
+    insertRows(row, QList<QVariantMap>() << properties);
+}
+
+/*!
+    \brief Removes the item at \a row.
     
-    if ((row < 0) || (row >= d->items.size())) {
-        append(properties);
+    Returns true if successful.
+*/
+bool Model::remove(int row) {
+    return removeRows(row, 1);
+}
+
+/*!
+    \brief Appends \a items to the model.
+    
+    The items are inserted with a single notification.
+*/
+void Model::appendRows(const QList<QVariantMap> &items) {
+    if (items.isEmpty()) {
         return;
     }
     
-    if (d->items.isEmpty()) {
-        d->setRoleNames(properties);
-    }
+    Q_D(Model);
     
-    beginInsertRows(QModelIndex(), row, row);
-    d->items.insert(row, properties);
-    endInsertRows();
-    emit countChanged(rowCount());
+    d->appendRows(items);
 }
 
 /*!
-    \brief Removes the item at \a row.
+    \brief Inserts \a items before \a row.
+    
+    The items are inserted with a single notification. If \a row is out of range, the items are appended.
+*/
+void Model::insertRows(int row, const QList<QVariantMap> &items) {
+    Q_D(Model);
+    
+    d->flushPendingItems();
+    
+    if ((row < 0) || (row >= d->count)) {
+        appendRows(items);
+    }
+    else {
+        d->insertRows(row, items);
+    }
+}
+
+/*!
+    \brief Removes \a count items starting at \a row.
+    
+    The items are removed with a single notification.
     
     Returns true if successful.
 */
-bool Model::remove(int row) {
+bool Model::removeRows(int row, int count, const QModelIndex &parent) {
+    if ((parent.isValid()) || (count <= 0)) {
+        return false;
+    }
+    
     Q_D(Model);
     
-    if ((row < 0) || (row >= d->items.size())) {
+    d->flushPendingItems();
+    
+    if ((row < 0) || (row + count > d->count)) {
         return false;
     }
     
-    beginRemoveRows(QModelIndex(), row, row);
-    d->items.removeAt(row);
+    d->_q_emitDataChanged();
+    beginRemoveRows(QModelIndex(), row, row + count - 1);
+    d->removeItems(row, count);
     endRemoveRows();
-    emit countChanged(rowCount());
+    d->emitCountChanged();
     
     return true;
 }
 
+/*!
+    \brief Starts a batch of changes to the model.
+    
+    Until the matching call to endBatch(), items appended to the model are held back and inserted together with 
+    a single notification, and countChanged() is emitted only once. Batches may be nested.
+    
+    Items appended during a batch are not visible via rowCount(), data() or get() until the batch ends, or until 
+    another insertion or removal requires them to be inserted.
+    
+    \sa endBatch()
+*/
+void Model::beginBatch() {
+    Q_D(Model);
+    
+    d->batchDepth++;
+}
+
+/*!
+    \brief Ends a batch of changes started with beginBatch().
+    
+    \sa beginBatch()
+*/
+void Model::endBatch() {
+    Q_D(Model);
+    
+    if (d->batchDepth == 0) {
+        return;
+    }
+    
+    d->batchDepth--;
+    
+    if (d->batchDepth == 0) {
+        d->flushPendingItems();
+        
+        if (d->countDirty) {
+            d->countDirty = false;
+            emit countChanged(rowCount());
+        }
+    }
+}
+
 /*!
     \brief Removes all items.
 */
 void Model::clear() {
     Q_D(Model);
     
-    if (!d->items.isEmpty()) {
+    d->pendingItems.clear();
+    d->changedRoles.clear();
+    
+    if (d->count > 0) {
         beginResetModel();
-        d->items.clear();
+        d->clearItems();
         endResetModel();
-        emit countChanged(rowCount());
+        d->emitCountChanged();
     }
 }
 
 ModelPrivate::ModelPrivate(Model *parent) :
-    q_ptr(parent)
+    q_ptr(parent),
+    nextRole(Qt::UserRole + 1),
+    roleNamesDirty(false),
+    count(0),
+    batchDepth(0),
+    countDirty(false),
+    dataChangedScheduled(false)
 {
 }
 
@@ -340,21 +483,660 @@ ModelPrivate::~ModelPrivate() {}
 
 /*!
     \internal
-    \brief Set the role names of the model using the unique keys of \a item.
+    \brief Set the role names of the model to \a names.
+    
+    Subclasses with a fixed set of roles use this to assign their role ids. Any existing column without a role 
+    in \a names is given a new one.
 */
-void ModelPrivate::setRoleNames(const QVariantMap &item) {    
+void ModelPrivate::setRoleNames(const QHash<int, QByteArray> &names) {
     roles.clear();
-    int role = Qt::UserRole + 1;
+    roleColumns.clear();
+    columnRoles.clear();
+    nextRole = Qt::UserRole + 1;
+    QHashIterator<int, QByteArray> iterator(names);
+    
+    while (iterator.hasNext()) {
+        iterator.next();
+        const QString key = QString::fromUtf8(iterator.value());
+        int c = column(key);
+        
+        if (c == -1) {
+            c = createColumn(key);
+        }
+        
+        setColumnRole(c, iterator.key());
+        nextRole = qMax(nextRole, iterator.key() + 1);
+    }
     
-    foreach (QString key, item.uniqueKeys()) {
-        roles[role] = key.toUtf8();
-        role++;
+    for (int c = 0; c < keys.size(); c++) {
+        if (!columnRoles.contains(c)) {
+            setColumnRole(c, nextRole++);
+        }
     }
-#if QT_VERSION < 0x050000
+    
+    roleNamesDirty = true;
+    emitRoleNamesChanged();
+}
+
+/*!
+    \internal
+    \brief Assigns \a role to \a column.
+*/
+void ModelPrivate::setColumnRole(int column, int role) {
+    roles[role] = keys.at(column).toUtf8();
+    roleColumns[role] = column;
+    columnRoles[column] = role;
+}
+
+/*!
+    \internal
+    \brief Adds a column, and a role, for each key in \a list that has not been seen before.
+    
+    This is called before rows are inserted, so that the role names are complete when views are notified of the 
+    new rows.
+*/
+void ModelPrivate::addColumns(const QList<QVariantMap> &list) {
+    foreach (const QVariantMap &item, list) {
+        QMapIterator<QString, QVariant> iterator(item);
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            addColumn(iterator.key());
+        }
+    }
+    
+    emitRoleNamesChanged();
+}
+
+/*!
+    \internal
+    \brief Emits Model::roleNamesChanged() if any roles have been added since it was last emitted.
+*/
+void ModelPrivate::emitRoleNamesChanged() {
+    if (!roleNamesDirty) {
+        return;
+    }
+    
     Q_Q(Model);
     
+    roleNamesDirty = false;
+#if QT_VERSION < 0x050000
     q->setRoleNames(roles);
 #endif
+    emit q->roleNamesChanged();
+}
+
+/*!
+    \internal
+    \brief Returns the column used to store the values of \a key, or -1 if there is no such column.
+*/
+int ModelPrivate::column(const QString &key) const {
+    return columns.value(key, -1);
+}
+
+/*!
+    \internal
+    \brief Returns the column used to store the values of \a key, creating it if needed.
+    
+    A new column is given the next unused role, which it keeps for the lifetime of the model.
+*/
+int ModelPrivate::addColumn(const QString &key) {
+    QHash<QString, int>::const_iterator iterator = columns.constFind(key);
+    
+    if (iterator != columns.constEnd()) {
+        return iterator.value();
+    }
+    
+    const int c = createColumn(key);
+    setColumnRole(c, nextRole++);
+    roleNamesDirty = true;
+    
+    return c;
+}
+
+/*!
+    \internal
+    \brief Creates an empty column for \a key, without a role.
+*/
+int ModelPrivate::createColumn(const QString &key) {
+    const int c = keys.size();
+    keys << key;
+    columns[key] = c;
+    columnData << ModelColumn(&strings, count);
+    
+    return c;
+}
+
+QVariant ModelPrivate::value(int row, int column) const {
+    if ((row < 0) || (row >= count) || (column < 0) || (column >= columnData.size())) {
+        return QVariant();
+    }
+    
+    return columnData.at(column).value(row);
+}
+
+QVariant ModelPrivate::value(int row, const QString &key) const {
+    return value(row, column(key));
+}
+
+void ModelPrivate::setValue(int row, int column, const QVariant &value) {
+    columnData[column].setValue(row, value);
+}
+
+void ModelPrivate::setValue(int row, const QString &key, const QVariant &value) {
+    columnData[addColumn(key)].setValue(row, value);
+}
+
+/*!
+    \internal
+    \brief Returns the item at \a row as a QVariantMap containing each key that has a value.
+*/
+QVariantMap ModelPrivate::item(int row) const {
+    QVariantMap map;
+    
+    if ((row >= 0) && (row < count)) {
+        for (int i = 0; i < columnData.size(); i++) {
+            const ModelColumn &c = columnData.at(i);
+            
+            if (c.isSet(row)) {
+                map[keys.at(i)] = c.value(row);
+            }
+        }
+    }
+    
+    return map;
+}
+
+/*!
+    \internal
+    \brief Inserts the items in \a list before \a row.
+    
+    New columns are created for any keys that have not been seen before. No signals are emitted.
+*/
+void ModelPrivate::insertItems(int row, const QList<QVariantMap> &list) {
+    if (list.isEmpty()) {
+        return;
+    }
+    
+    const int n = list.size();
+    
+    for (int i = 0; i < columnData.size(); i++) {
+        columnData[i].insert(row, n);
+    }
+    
+    count += n;
+    
+    for (int i = 0; i < n; i++) {
+        QMapIterator<QString, QVariant> iterator(list.at(i));
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            setValue(row + i, iterator.key(), iterator.value());
+        }
+    }
+    
+    itemsInserted(row, n);
+}
+
+/*!
+    \internal
+    \brief Removes \a n items starting at \a row. No signals are emitted.
+*/
+void ModelPrivate::removeItems(int row, int n) {
+    for (int i = 0; i < columnData.size(); i++) {
+        columnData[i].remove(row, n);
+    }
+    
+    count -= n;
+    itemsRemoved(row, n);
+}
+
+/*!
+    \internal
+    \brief Removes all items, keeping the existing columns. No signals are emitted.
+*/
+void ModelPrivate::clearItems() {
+    for (int i = 0; i < columnData.size(); i++) {
+        columnData[i].clear();
+    }
+    
+    strings.clear();
+    count = 0;
+    itemsCleared();
+}
+
+/*!
+    \internal
+    \brief Called when the item at \a row is read by Model::data().
+    
+    The default implementation does nothing.
+*/
+void ModelPrivate::itemAccessed(int) {}
+
+/*!
+    \internal
+    \brief Called after \a n items are inserted at \a row.
+    
+    The default implementation does nothing.
+*/
+void ModelPrivate::itemsInserted(int, int) {}
+
+/*!
+    \internal
+    \brief Called after \a n items are removed from \a row.
+    
+    The default implementation does nothing.
+*/
+void ModelPrivate::itemsRemoved(int, int) {}
+
+/*!
+    \internal
+    \brief Called after all items are removed.
+    
+    The default implementation does nothing.
+*/
+void ModelPrivate::itemsCleared() {}
+
+/*!
+    \internal
+    \brief Appends \a list and notifies any views, or holds the items back if a batch is in progress.
+*/
+void ModelPrivate::appendRows(const QList<QVariantMap> &list) {
+    if (list.isEmpty()) {
+        return;
+    }
+    
+    if (batchDepth > 0) {
+        pendingItems << list;
+        return;
+    }
+    
+    Q_Q(Model);
+    
+    addColumns(list);
+    q->beginInsertRows(QModelIndex(), count, count + list.size() - 1);
+    insertItems(count, list);
+    q->endInsertRows();
+    emitCountChanged();
+}
+
+/*!
+    \internal
+    \brief Inserts \a list before \a row and notifies any views.
+*/
+void ModelPrivate::insertRows(int row, const QList<QVariantMap> &list) {
+    if (list.isEmpty()) {
+        return;
+    }
+    
+    Q_Q(Model);
+    
+    flushPendingItems();
+    _q_emitDataChanged();
+    addColumns(list);
+    q->beginInsertRows(QModelIndex(), row, row + list.size() - 1);
+    insertItems(row, list);
+    q->endInsertRows();
+    emitCountChanged();
+}
+
+/*!
+    \internal
+    \brief Inserts any items held back during a batch.
+*/
+void ModelPrivate::flushPendingItems() {
+    if (pendingItems.isEmpty()) {
+        return;
+    }
+    
+    Q_Q(Model);
+    
+    const QList<QVariantMap> list = pendingItems;
+    pendingItems.clear();
+    addColumns(list);
+    q->beginInsertRows(QModelIndex(), count, count + list.size() - 1);
+    insertItems(count, list);
+    q->endInsertRows();
+    emitCountChanged();
+}
+
+/*!
+    \internal
+    \brief Emits Model::countChanged(), or defers it until the end of the current batch.
+*/
+void ModelPrivate::emitCountChanged() {
+    if (batchDepth > 0) {
+        countDirty = true;
+    }
+    else {
+        Q_Q(Model);
+        emit q->countChanged(q->rowCount());
+    }
+}
+
+/*!
+    \internal
+    \brief Records a change to the value in \a column of the item at \a row.
+    
+    The change is reported by _q_emitDataChanged() on the next event loop iteration.
+*/
+void ModelPrivate::dataChanged(int row, int column) {
+    QHash<int, int>::const_iterator role = columnRoles.constFind(column);
+    
+    if (role == columnRoles.constEnd()) {
+        return;
+    }
+    
+    changedRoles[row].insert(role.value());
+    
+    if (!dataChangedScheduled) {
+        Q_Q(Model);
+        dataChangedScheduled = true;
+        QMetaObject::invokeMethod(q, "_q_emitDataChanged", Qt::QueuedConnection);
+    }
+}
+
+/*!
+    \internal
+    \brief Emits Model::dataChanged() for the changes recorded by dataChanged().
+    
+    Adjacent rows are merged into a single range, and the changed roles of the rows in the range are combined.
+    
+    This is called before rows are inserted or removed, so that the recorded rows are still valid.
+*/
+void ModelPrivate::_q_emitDataChanged() {
+    dataChangedScheduled = false;
+    
+    if (changedRoles.isEmpty()) {
+        return;
+    }
+    
+    Q_Q(Model);
+    
+    const QMap<int, QSet<int> > changed = changedRoles;
+    changedRoles.clear();
+    QMapIterator<int, QSet<int> > iterator(changed);
+    
+    while (iterator.hasNext()) {
+        iterator.next();
+        const int first = iterator.key();
+        int last = first;
+        QSet<int> roleSet = iterator.value();
+        
+        while ((iterator.hasNext()) && (iterator.peekNext().key() == last + 1)) {
+            iterator.next();
+            last = iterator.key();
+            roleSet.unite(iterator.value());
+        }
+#if QT_VERSION >= 0x050000
+        QVector<int> roleVector;
+        roleVector.reserve(roleSet.size());
+        
+        foreach (int role, roleSet) {
+            roleVector << role;
+        }
+        
+        std::sort(roleVector.begin(), roleVector.end());
+        emit q->dataChanged(q->index(first), q->index(last), roleVector);
+#else
+        emit q->dataChanged(q->index(first), q->index(last));
+#endif
+    }
+}
+
+/*!
+    \internal
+    \class ModelColumn
+    \brief Stores the values of a single key for every item in a Model.
+    
+    Values are kept in a typed array chosen from the first value stored in the column, so integers, booleans and 
+    doubles take a fixed number of bytes per row and strings are stored as ids into a shared ModelStringPool. 
+    A column is converted to a QVariant array if it is given a value that does not match its type.
+    
+    The QVariant type of each value is kept in types, so that values are returned with the type they were stored 
+    with. QVariant::Invalid marks a row with no value.
+*/
+ModelColumn::ModelColumn(ModelStringPool *pool, int count) :
+    type(NullType),
+    types(count, quint8(QVariant::Invalid)),
+    pool(pool)
+{
+}
+
+QVariant ModelColumn::value(int row) const {
+    const int t = types.at(row);
+    
+    switch (type) {
+    case IntegerType:
+        switch (t) {
+        case QVariant::Bool:
+            return QVariant(integers.at(row) != 0);
+        case QVariant::Int:
+            return QVariant(int(integers.at(row)));
+        case QVariant::UInt:
+            return QVariant(uint(integers.at(row)));
+        case QVariant::LongLong:
+            return QVariant(qlonglong(integers.at(row)));
+        case QVariant::ULongLong:
+            return QVariant(qulonglong(integers.at(row)));
+        default:
+            return QVariant();
+        }
+    case DoubleType:
+        return t == QVariant::Invalid ? QVariant() : QVariant(doubles.at(row));
+    case StringType:
+        return t == QVariant::Invalid ? QVariant() : QVariant(pool->string(strings.at(row)));
+    case VariantType:
+        return variants.at(row);
+    default:
+        return QVariant();
+    }
+}
+
+void ModelColumn::setValue(int row, const QVariant &value) {
+    const Type t = columnType(value.type());
+    
+    if (t == NullType) {
+        if (isSet(row)) {
+            if (type == StringType) {
+                pool->release(strings.at(row));
+                strings[row] = -1;
+            }
+            else if (type == VariantType) {
+                variants[row] = QVariant();
+            }
+            
+            types[row] = QVariant::Invalid;
+        }
+        
+        return;
+    }
+    
+    if (type == NullType) {
+        type = t;
+        
+        switch (type) {
+        case IntegerType:
+            integers.fill(0, types.size());
+            break;
+        case DoubleType:
+            doubles.fill(0, types.size());
+            break;
+        case StringType:
+            strings.fill(-1, types.size());
+            break;
+        default:
+            variants.resize(types.size());
+            break;
+        }
+    }
+    else if ((t != type) && (type != VariantType)) {
+        promote();
+    }
+    
+    switch (type) {
+    case IntegerType:
+        integers[row] = (value.type() == QVariant::ULongLong ? qint64(value.toULongLong()) : value.toLongLong());
+        types[row] = value.type();
+        break;
+    case DoubleType:
+        doubles[row] = value.toDouble();
+        types[row] = QVariant::Double;
+        break;
+    case StringType: {
+        const int id = pool->intern(value.toString());
+        
+        if (isSet(row)) {
+            pool->release(strings.at(row));
+        }
+        
+        strings[row] = id;
+        types[row] = QVariant::String;
+        break;
+    }
+    default:
+        variants[row] = value;
+        types[row] = VARIANT_CELL;
+        break;
+    }
+}
+
+void ModelColumn::insert(int row, int count) {
+    types.insert(row, count, quint8(QVariant::Invalid));
+    
+    switch (type) {
+    case IntegerType:
+        integers.insert(row, count, 0);
+        break;
+    case DoubleType:
+        doubles.insert(row, count, 0);
+        break;
+    case StringType:
+        strings.insert(row, count, -1);
+        break;
+    case VariantType:
+        variants.insert(row, count, QVariant());
+        break;
+    default:
+        break;
+    }
+}
+
+void ModelColumn::remove(int row, int count) {
+    types.remove(row, count);
+    
+    switch (type) {
+    case IntegerType:
+        integers.remove(row, count);
+        break;
+    case DoubleType:
+        doubles.remove(row, count);
+        break;
+    case StringType:
+        for (int i = row; i < row + count; i++) {
+            if (strings.at(i) != -1) {
+                pool->release(strings.at(i));
+            }
+        }
+        
+        strings.remove(row, count);
+        break;
+    case VariantType:
+        variants.remove(row, count);
+        break;
+    default:
+        break;
+    }
+}
+
+/*!
+    \internal
+    \brief Removes all values and resets the column type.
+    
+    String ids are not released, so the string pool should be cleared at the same time.
+*/
+void ModelColumn::clear() {
+    type = NullType;
+    types.clear();
+    integers.clear();
+    doubles.clear();
+    strings.clear();
+    variants.clear();
+}
+
+/*!
+    \internal
+    \brief Converts the column to a QVariant array.
+*/
+void ModelColumn::promote() {
+    QVector<QVariant> list(types.size());
+    
+    for (int i = 0; i < types.size(); i++) {
+        if (isSet(i)) {
+            list[i] = value(i);
+            
+            if (type == StringType) {
+                pool->release(strings.at(i));
+            }
+            
+            types[i] = VARIANT_CELL;
+        }
+    }
+    
+    integers.clear();
+    doubles.clear();
+    strings.clear();
+    variants = list;
+    type = VariantType;
+}
+
+/*!
+    \internal
+    \class ModelStringPool
+    \brief A reference counted store of the string values held by a Model.
+    
+    Equal strings are stored once and referred to by id.
+*/
+int ModelStringPool::intern(const QString &s) {
+    QHash<QString, int>::const_iterator iterator = ids.constFind(s);
+    
+    if (iterator != ids.constEnd()) {
+        refs[iterator.value()]++;
+        return iterator.value();
+    }
+    
+    int id;
+    
+    if (!freeIds.isEmpty()) {
+        id = freeIds.last();
+        freeIds.remove(freeIds.size() - 1);
+        strings[id] = s;
+        refs[id] = 1;
+    }
+    else {
+        id = strings.size();
+        strings.append(s);
+        refs.append(1);
+    }
+    
+    ids.insert(s, id);
+    
+    return id;
+}
+
+void ModelStringPool::release(int id) {
+    if (--refs[id] == 0) {
+        ids.remove(strings.at(id));
+        strings[id] = QString();
+        freeIds.append(id);
+    }
+}
+
+void ModelStringPool::clear() {
+    strings.clear();
+    refs.clear();
+    freeIds.clear();
+    ids.clear();
 }
 
 }
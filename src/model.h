@@ -57,12 +57,21 @@ public:
     Q_INVOKABLE void append(const QVariantMap &properties);
     Q_INVOKABLE void insert(int row, const QVariantMap &properties);
     Q_INVOKABLE bool remove(int row);
+    
+    void appendRows(const QList<QVariantMap> &items);
+    void insertRows(int row, const QList<QVariantMap> &items);
+    bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex());
+    using QAbstractListModel::insertRows;
+    
+    Q_INVOKABLE void beginBatch();
+    Q_INVOKABLE void endBatch();
 
 public Q_SLOTS:
     void clear();
     
 Q_SIGNALS:
     void countChanged(int c);
+    void roleNamesChanged();
     
 protected:
     Model(ModelPrivate &dd, QObject *parent = 0);
@@ -73,6 +82,8 @@ protected:
     
 private:
     Q_DISABLE_COPY(Model)
+    
+    Q_PRIVATE_SLOT(d_func(), void _q_emitDataChanged())
 };
 
 }
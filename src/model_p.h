@@ -18,9 +18,67 @@
 #define QSOUNDCLOUD_MODEL_P_H
 
 #include "model.h"
+#include <QSet>
+#include <QStringList>
+#include <QVector>
 
 namespace QSoundCloud {
 
+class ModelStringPool
+{
+
+public:
+    int intern(const QString &s);
+    void release(int id);
+    
+    inline const QString& string(int id) const { return strings.at(id); }
+    
+    void clear();
+
+private:
+    QVector<QString> strings;
+    QVector<int> refs;
+    QVector<int> freeIds;
+    QHash<QString, int> ids;
+};
+
+class ModelColumn
+{
+
+public:
+    enum Type {
+        NullType = 0,
+        IntegerType,
+        DoubleType,
+        StringType,
+        VariantType
+    };
+    
+    ModelColumn(ModelStringPool *pool = 0, int count = 0);
+    
+    inline bool isSet(int row) const { return types.at(row) != QVariant::Invalid; }
+    
+    QVariant value(int row) const;
+    void setValue(int row, const QVariant &value);
+    
+    void insert(int row, int count);
+    void remove(int row, int count);
+    void clear();
+    
+    Type type;
+    
+    QVector<quint8> types;
+    QVector<qint64> integers;
+    QVector<double> doubles;
+    QVector<int> strings;
+    QVector<QVariant> variants;
+
+private:
+    void promote();
+    
+    ModelStringPool *pool;
+};
+
 class ModelPrivate
 {
 
@@ -28,13 +86,63 @@ public:
     ModelPrivate(Model *parent);
     virtual ~ModelPrivate();
     
-    void setRoleNames(const QVariantMap &item);
-        
+    void setRoleNames(const QHash<int, QByteArray> &names);
+    void setColumnRole(int column, int role);
+    
+    int column(const QString &key) const;
+    int addColumn(const QString &key);
+    int createColumn(const QString &key);
+    void addColumns(const QList<QVariantMap> &list);
+    
+    void emitRoleNamesChanged();
+    
+    QVariant value(int row, int column) const;
+    QVariant value(int row, const QString &key) const;
+    void setValue(int row, int column, const QVariant &value);
+    void setValue(int row, const QString &key, const QVariant &value);
+    
+    QVariantMap item(int row) const;
+    
+    void insertItems(int row, const QList<QVariantMap> &list);
+    void removeItems(int row, int n);
+    void clearItems();
+    
+    void appendRows(const QList<QVariantMap> &list);
+    void insertRows(int row, const QList<QVariantMap> &list);
+    void flushPendingItems();
+    
+    void emitCountChanged();
+    
+    virtual void itemAccessed(int row);
+    virtual void itemsInserted(int row, int n);
+    virtual void itemsRemoved(int row, int n);
+    virtual void itemsCleared();
+    
+    void dataChanged(int row, int column);
+    void _q_emitDataChanged();
+    
     Model *q_ptr;
     
     QHash<int, QByteArray> roles;
+    QHash<int, int> roleColumns;
+    QHash<int, int> columnRoles;
+    int nextRole;
+    bool roleNamesDirty;
+    
+    QStringList keys;
+    QHash<QString, int> columns;
+    QList<ModelColumn> columnData;
+    
+    ModelStringPool strings;
+    
+    int count;
+    
+    int batchDepth;
+    bool countDirty;
+    QList<QVariantMap> pendingItems;
     
-    QList<QVariantMap> items;
+    QMap<int, QSet<int> > changedRoles;
+    bool dataChangedScheduled;
     
     Q_DECLARE_PUBLIC(Model)
 };
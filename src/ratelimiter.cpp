@@ -0,0 +1,359 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ratelimiter_p.h"
+#include <QDateTime>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QUrl>
+#ifdef QSOUNDCLOUD_DEBUG
+#include <QDebug>
+#endif
+
+namespace QSoundCloud {
+
+// The period over which the rate of requests is measured, in milliseconds.
+static const qint64 RATE_WINDOW = 10000;
+// The pause after an HTTP 429 response without a Retry-After header, in milliseconds.
+static const qint64 THROTTLE_PAUSE = 1000;
+// The lowest rate to which requests are slowed, in requests per second.
+static const qreal MINIMUM_RATE = 0.1;
+// The fraction of the original rate that is restored after each successful request.
+static const qreal RECOVERY_RATE = 0.05;
+
+class RateLimit
+{
+
+public:
+    RateLimit() :
+        rate(0),
+        burst(1)
+    {
+    }
+    
+    RateLimit(qreal rate, int burst) :
+        rate(rate),
+        burst(burst)
+    {
+    }
+    
+    qreal rate;
+    int burst;
+};
+
+class RateLimits
+{
+
+public:
+    RateLimits() :
+        adaptive(true)
+    {
+    }
+    
+    QString endpoint(const QString &path) const {
+        QString match;
+        QMapIterator<QString, RateLimit> iterator(endpointLimits);
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            const QString &key = iterator.key();
+            
+            if ((key.size() > match.size()) && ((path == key) || (path.startsWith(key + "/")))) {
+                match = key;
+            }
+        }
+        
+        return match;
+    }
+    
+    QMutex mutex;
+    
+    RateLimit clientLimit;
+    
+    QMap<QString, RateLimit> endpointLimits;
+    
+    bool adaptive;
+    
+    QHash<QString, RateBucket> buckets;
+};
+
+Q_GLOBAL_STATIC(RateLimits, rateLimits)
+
+RateBucket::RateBucket() :
+    rate(0),
+    burst(1),
+    adaptiveRate(0),
+    ceiling(0),
+    nextFree(0),
+    pausedUntil(0),
+    windowStart(0),
+    windowCount(0),
+    observedRate(0)
+{
+}
+
+qreal RateBucket::effectiveRate() const {
+    if ((adaptiveRate > 0) && ((rate <= 0) || (adaptiveRate < rate))) {
+        return adaptiveRate;
+    }
+    
+    return rate;
+}
+
+qint64 RateBucket::reserve(qint64 now) {
+    // Measure the rate of requests, so that it can be reduced if the server asks for fewer requests.
+    if (now - windowStart >= RATE_WINDOW) {
+        if (windowStart > 0) {
+            observedRate = windowCount * 1000.0 / (now - windowStart);
+        }
+        
+        windowStart = now;
+        windowCount = 0;
+    }
+    
+    windowCount++;
+    
+    const qint64 start = qMax(now, pausedUntil);
+    const qreal r = effectiveRate();
+    
+    if (r <= 0) {
+        return start - now;
+    }
+    
+    // nextFree is the time by which every permit reserved so far will have been replaced. Unused permits accumulate
+    // up to burst, so it is never less than burst intervals before the start. Each request takes a permit before
+    // its wait is computed, so no more than burst requests are sent at once, and requests are sent in the order in
+    // which they were reserved.
+    const qreal interval = 1000.0 / r;
+    nextFree = qMax(nextFree, start - qint64(burst * interval)) + qint64(interval);
+    return qMax(start, nextFree) - now;
+}
+
+void RateBucket::throttle(qint64 now, qint64 pause) {
+    qreal current = effectiveRate();
+    
+    if (current <= 0) {
+        current = qMax(observedRate, windowCount * 1000.0 / qMax(qint64(1), now - windowStart));
+    }
+    
+    if (adaptiveRate <= 0) {
+        ceiling = current;
+    }
+    
+    adaptiveRate = qMax(MINIMUM_RATE, current / 2);
+    pausedUntil = qMax(pausedUntil, now + (pause > 0 ? pause : THROTTLE_PAUSE));
+#ifdef QSOUNDCLOUD_DEBUG
+    qDebug() << "QSoundCloud::RateBucket::throttle" << current << adaptiveRate << pausedUntil - now;
+#endif
+}
+
+void RateBucket::recover() {
+    if (adaptiveRate <= 0) {
+        return;
+    }
+    
+    adaptiveRate += ceiling * RECOVERY_RATE;
+    
+    if (adaptiveRate >= ceiling) {
+        adaptiveRate = 0;
+    }
+}
+
+qint64 RateLimiterPrivate::reserve(const QString &clientId, const QUrl &url) {
+    RateLimits *limits = rateLimits();
+    QMutexLocker locker(&limits->mutex);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    
+    RateBucket &client = limits->buckets[clientId];
+    client.rate = limits->clientLimit.rate;
+    client.burst = limits->clientLimit.burst;
+    qint64 wait = client.reserve(now);
+    
+    const QString endpoint = limits->endpoint(url.path());
+    
+    if (!endpoint.isEmpty()) {
+        const RateLimit limit = limits->endpointLimits.value(endpoint);
+        RateBucket &bucket = limits->buckets[clientId + "\n" + endpoint];
+        bucket.rate = limit.rate;
+        bucket.burst = limit.burst;
+        wait = qMax(wait, bucket.reserve(now));
+    }
+    
+    return wait;
+}
+
+void RateLimiterPrivate::report(const QString &clientId, const QUrl &url, int statusCode, qint64 retryAfter) {
+    RateLimits *limits = rateLimits();
+    QMutexLocker locker(&limits->mutex);
+    
+    if (!limits->adaptive) {
+        return;
+    }
+    
+    const QString endpoint = limits->endpoint(url.path());
+    QList<QString> keys;
+    keys << clientId;
+    
+    if (!endpoint.isEmpty()) {
+        keys << clientId + "\n" + endpoint;
+    }
+    
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    
+    foreach (const QString &key, keys) {
+        QHash<QString, RateBucket>::iterator iterator = limits->buckets.find(key);
+        
+        if (iterator == limits->buckets.end()) {
+            continue;
+        }
+        
+        if (statusCode == 429) {
+            iterator.value().throttle(now, retryAfter);
+        }
+        else if ((statusCode >= 200) && (statusCode < 400)) {
+            iterator.value().recover();
+        }
+    }
+}
+
+/*!
+    \class RateLimiter
+    \brief Limits the rate at which requests are made to the SoundCloud Data API.
+    
+    \ingroup requests
+    
+    RateLimiter keeps the requests made by the library within the quotas of the SoundCloud Data API. Rather than
+    failing, a request that would exceed a limit waits until it can be made, with the status Loading. Requests wait
+    in the order in which they were made.
+    
+    The rate for each client id can be set using setClientRate(), and further limits can be set for particular
+    endpoints using setEndpointRate(). Both are token buckets: requests can be made in bursts of up to burst
+    requests, after which they are limited to the given number of requests per second. By default, there are no
+    limits.
+    
+    If adaptive rate limiting is enabled (the default), an HTTP 429 (Too Many Requests) response pauses all
+    requests for the same client id (and endpoint) until the time given by the Retry-After header, and halves
+    their rate. The rate is then restored gradually as requests succeed.
+    
+    Example usage:
+    
+    \code
+    QSoundCloud::RateLimiter::setClientRate(10, 20);
+    QSoundCloud::RateLimiter::setEndpointRate("/search", 1);
+    \endcode
+*/
+
+/*!
+    \brief Returns the maximum number of requests per second for each client id.
+    
+    A value of 0 means that there is no limit.
+*/
+qreal RateLimiter::clientRate() {
+    RateLimits *limits = rateLimits();
+    QMutexLocker locker(&limits->mutex);
+    return limits->clientLimit.rate;
+}
+
+/*!
+    \brief Returns the number of requests that can be made at once for each client id.
+*/
+int RateLimiter::clientBurst() {
+    RateLimits *limits = rateLimits();
+    QMutexLocker locker(&limits->mutex);
+    return limits->clientLimit.burst;
+}
+
+/*!
+    \brief Limits the requests made for each client id to \a requestsPerSecond, in bursts of up to \a burst.
+    
+    A \a requestsPerSecond of 0 removes the limit.
+*/
+void RateLimiter::setClientRate(qreal requestsPerSecond, int burst) {
+    RateLimits *limits = rateLimits();
+    QMutexLocker locker(&limits->mutex);
+    limits->clientLimit = RateLimit(qMax(qreal(0), requestsPerSecond), qMax(1, burst));
+}
+
+/*!
+    \brief Returns the maximum number of requests per second to the endpoint at \a path.
+*/
+qreal RateLimiter::endpointRate(const QString &path) {
+    RateLimits *limits = rateLimits();
+    QMutexLocker locker(&limits->mutex);
+    return limits->endpointLimits.value(path).rate;
+}
+
+/*!
+    \brief Returns the number of requests that can be made at once to the endpoint at \a path.
+*/
+int RateLimiter::endpointBurst(const QString &path) {
+    RateLimits *limits = rateLimits();
+    QMutexLocker locker(&limits->mutex);
+    return limits->endpointLimits.value(path).burst;
+}
+
+/*!
+    \brief Limits the requests made to the endpoint at \a path to \a requestsPerSecond, in bursts of up to \a burst.
+    
+    The limit applies to \a path and the resources below it, so a limit for "/tracks" also applies to
+    "/tracks/123/comments", unless there is a limit for a longer path. The limit is applied separately for each
+    client id, in addition to the limit set by setClientRate().
+*/
+void RateLimiter::setEndpointRate(const QString &path, qreal requestsPerSecond, int burst) {
+    RateLimits *limits = rateLimits();
+    QMutexLocker locker(&limits->mutex);
+    limits->endpointLimits[path] = RateLimit(qMax(qreal(0), requestsPerSecond), qMax(1, burst));
+}
+
+/*!
+    \brief Removes the limit for the endpoint at \a path.
+*/
+void RateLimiter::removeEndpointRate(const QString &path) {
+    RateLimits *limits = rateLimits();
+    QMutexLocker locker(&limits->mutex);
+    limits->endpointLimits.remove(path);
+}
+
+/*!
+    \brief Returns true if requests are slowed down when the server responds with HTTP 429.
+*/
+bool RateLimiter::isAdaptive() {
+    RateLimits *limits = rateLimits();
+    QMutexLocker locker(&limits->mutex);
+    return limits->adaptive;
+}
+
+/*!
+    \brief Sets whether requests are slowed down when the server responds with HTTP 429 to \a enabled.
+*/
+void RateLimiter::setAdaptive(bool enabled) {
+    RateLimits *limits = rateLimits();
+    QMutexLocker locker(&limits->mutex);
+    limits->adaptive = enabled;
+    
+    if (!enabled) {
+        QMutableHashIterator<QString, RateBucket> iterator(limits->buckets);
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            iterator.value().adaptiveRate = 0;
+            iterator.value().pausedUntil = 0;
+        }
+    }
+}
+
+}
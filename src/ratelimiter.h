@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QSOUNDCLOUD_RATELIMITER_H
+#define QSOUNDCLOUD_RATELIMITER_H
+
+#include "qsoundcloud_global.h"
+#include <QString>
+
+namespace QSoundCloud {
+
+class QSOUNDCLOUDSHARED_EXPORT RateLimiter
+{
+
+public:
+    static qreal clientRate();
+    static int clientBurst();
+    static void setClientRate(qreal requestsPerSecond, int burst = 1);
+    
+    static qreal endpointRate(const QString &path);
+    static int endpointBurst(const QString &path);
+    static void setEndpointRate(const QString &path, qreal requestsPerSecond, int burst = 1);
+    static void removeEndpointRate(const QString &path);
+    
+    static bool isAdaptive();
+    static void setAdaptive(bool enabled);
+};
+
+}
+
+#endif // QSOUNDCLOUD_RATELIMITER_H
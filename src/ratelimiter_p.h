@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QSOUNDCLOUD_RATELIMITER_P_H
+#define QSOUNDCLOUD_RATELIMITER_P_H
+
+#include "ratelimiter.h"
+
+class QUrl;
+
+namespace QSoundCloud {
+
+class RateBucket
+{
+
+public:
+    RateBucket();
+    
+    qreal effectiveRate() const;
+    
+    qint64 reserve(qint64 now);
+    
+    void throttle(qint64 now, qint64 pause);
+    void recover();
+    
+    qreal rate;
+    int burst;
+    
+    qreal adaptiveRate;
+    qreal ceiling;
+    
+    qint64 nextFree;
+    qint64 pausedUntil;
+    
+    qint64 windowStart;
+    int windowCount;
+    qreal observedRate;
+};
+
+class RateLimiterPrivate
+{
+
+public:
+    static qint64 reserve(const QString &clientId, const QUrl &url);
+    
+    static void report(const QString &clientId, const QUrl &url, int statusCode, qint64 retryAfter);
+};
+
+}
+
+#endif // QSOUNDCLOUD_RATELIMITER_P_H
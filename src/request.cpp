@@ -15,9 +15,19 @@
  */
 
 #include "request_p.h"
+#include "metrics_p.h"
+#include "ratelimiter_p.h"
+#include "requestobserver.h"
+#include "requestscheduler_p.h"
+#include "tokenmanager_p.h"
+#include "tracer.h"
 #include "urls.h"
+#include <QDateTime>
+#include <QLocale>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
+#include <QPointer>
+#include <QTimer>
 #include <QDebug>
 
 namespace QSoundCloud {
@@ -30,26 +40,65 @@ namespace QSoundCloud {
     
     Normally, there should be no need to use this class, but it can be useful if you need to extend the range of API 
     requests beyond those provided in the existing subclasses.   
+    
+    If a request fails because the access token has expired, and a refresh token has been set, the access token is 
+    refreshed and the request is made again. Only one request refreshes a given refresh token at a time. Other 
+    requests that need the same token refreshed wait for it, and every request with that refresh token is given the 
+    new tokens when the refresh has finished. An access token whose expiry is known, such as one obtained using 
+    AuthenticationRequest, is refreshed in the background shortly before it expires, so long as it is in use.
+    
+    If a TokenStore has been set, a request is given the stored credentials when it is created.
+    
+    A request that fails because of a transient error, such as a temporary network failure or an HTTP 503 
+    response, is retried according to its retryPolicy. The status remains Loading until the request has succeeded 
+    or there are no more retries.
+    
+    A request that takes too long fails with TimeoutError, according to its timeoutPolicy.
+    
+    The time taken by each phase of the last request is given by timings(), and can be observed for every request 
+    using RequestObserver.
+    
+    Requests are made within the limits set using RateLimiter. A request that would exceed a limit waits until it 
+    can be made, and its status is Loading while it waits.
+    
+    The number of requests in progress at the same time can be limited using RequestScheduler according to their 
+    priority. Requests that respond directly to the user should be given InteractivePriority, so that they are not 
+    kept waiting by prefetches and other bulk transfers.
 */
 Request::Request(QObject *parent) :
     QObject(parent),
     d_ptr(new RequestPrivate(this))
 {
+    Q_D(Request);
+    
+    d->init();
 }
 
 Request::Request(RequestPrivate &dd, QObject *parent) :
     QObject(parent),
     d_ptr(&dd)
 {
+    Q_D(Request);
+    
+    d->init();
 }
 
 Request::~Request() {
     Q_D(Request);
     
+    RequestSchedulerPrivate::release(this);
+    
+    if (d->refreshingToken) {
+        disconnect(TokenManager::instance(), 0, this, 0);
+        d->abandonTokenRefresh();
+    }
+    
     if (d->reply) {
         delete d->reply;
         d->reply = 0;
     }
+    
+    d->endTrace();
 }
 
 /*!
@@ -498,6 +547,145 @@ QString Request::errorString() const {
     return d->errorString;
 }
 
+/*!
+    \brief Returns the policy used to retry the request after a transient error.
+    
+    \sa RetryPolicy
+*/
+RetryPolicy Request::retryPolicy() const {
+    Q_D(const Request);
+    
+    return d->retryPolicy;
+}
+
+/*!
+    \brief Sets the policy used to retry the request after a transient error to \a policy.
+    
+    The default is RetryPolicy::defaultPolicy().
+*/
+void Request::setRetryPolicy(const RetryPolicy &policy) {
+    Q_D(Request);
+    
+    d->retryPolicy = policy;
+}
+
+/*!
+    \property int Request::retries
+    \brief The number of times that the last request was retried.
+*/
+int Request::retries() const {
+    Q_D(const Request);
+    
+    return d->retries;
+}
+
+/*!
+    \property int Request::retryDelay
+    \brief The total time in milliseconds that the last request waited before being retried.
+*/
+int Request::retryDelay() const {
+    Q_D(const Request);
+    
+    return d->retryDelay;
+}
+
+/*!
+    \brief Returns the policy that determines how long the request can take.
+    
+    \sa TimeoutPolicy
+*/
+TimeoutPolicy Request::timeoutPolicy() const {
+    Q_D(const Request);
+    
+    return d->timeoutPolicy;
+}
+
+/*!
+    \brief Sets the policy that determines how long the request can take to \a policy.
+    
+    The default is TimeoutPolicy::defaultPolicy(). A change of policy applies to the next request.
+*/
+void Request::setTimeoutPolicy(const TimeoutPolicy &policy) {
+    Q_D(Request);
+    
+    d->timeoutPolicy = policy;
+}
+
+/*!
+    \brief Returns the timings of the last request.
+    
+    The timings are complete when finished() has been emitted, apart from RequestTimings::handled, which is set 
+    when every slot connected to finished() has returned.
+    
+    \sa RequestTimings, RequestObserver
+*/
+RequestTimings Request::timings() const {
+    Q_D(const Request);
+    
+    return d->timings;
+}
+
+/*!
+    \enum Request::Priority
+    \brief The priority with which requests are scheduled.
+    
+    Can be one of the following:
+    
+    <table>
+        <tr>
+            <th>Value</th>
+            <th>Description</th>
+        </tr>
+        <tr>
+            <td>InteractivePriority</td>
+            <td>A request that the user is waiting for, such as the track that has just been selected.</td>
+        </tr>
+        <tr>
+            <td>NormalPriority</td>
+            <td>The default priority.</td>
+        </tr>
+        <tr>
+            <td>PrefetchPriority</td>
+            <td>A request for data that may be needed soon, such as the next page of a model.</td>
+        </tr>
+        <tr>
+            <td>BackgroundPriority</td>
+            <td>A bulk transfer, such as fetching every page of a model.</td>
+        </tr>
+    </table>
+    
+    \sa RequestScheduler
+*/
+
+/*!
+    \property Priority Request::priority
+    \brief The priority with which requests are scheduled.
+    
+    The default is NormalPriority. A change of priority applies to the next request.
+*/
+
+/*!
+    \fn void Request::priorityChanged()
+    \brief Emitted when the priority changes.
+*/
+Request::Priority Request::priority() const {
+    Q_D(const Request);
+    
+    return d->priority;
+}
+
+void Request::setPriority(Request::Priority p) {
+    Q_D(Request);
+    
+    if (p != d->priority) {
+        d->priority = p;
+        emit priorityChanged();
+    }
+#ifdef QSOUNDCLOUD_DEBUG
+    qDebug() << "QSoundCloud::Request::setPriority" << p;
+#endif
+}
+
 /*!
     \brief Sets the QNetworkAccessManager instance to be used 
     when making requests to the SoundCloud API.
@@ -532,18 +720,13 @@ void Request::head(bool authRequired) {
         return;
     }
     
-    d->redirects = 0;
+    d->startOperation();
     d->setOperation(HeadOperation);
     d->setStatus(Loading);
-    
-    if (d->reply) {
-        delete d->reply;
-    }
 #ifdef QSOUNDCLOUD_DEBUG
     qDebug() << "QSoundCloud::Request::head" << d->url;
 #endif
-    d->reply = d->networkAccessManager()->head(d->buildRequest(authRequired));
-    connect(d->reply, SIGNAL(finished()), this, SLOT(_q_onReplyFinished()));
+    d->schedule(authRequired);
 }
 
 /*!
@@ -557,18 +740,13 @@ void Request::get(bool authRequired) {
         return;
     }
     
-    d->redirects = 0;
+    d->startOperation();
     d->setOperation(GetOperation);
     d->setStatus(Loading);
-    
-    if (d->reply) {
-        delete d->reply;
-    }
 #ifdef QSOUNDCLOUD_DEBUG
     qDebug() << "QSoundCloud::Request::get" << d->url;
 #endif
-    d->reply = d->networkAccessManager()->get(d->buildRequest(authRequired));
-    connect(d->reply, SIGNAL(finished()), this, SLOT(_q_onReplyFinished()));
+    d->schedule(authRequired);
 }
 
 /*!
@@ -582,7 +760,7 @@ void Request::post(bool authRequired) {
         return;
     }
     
-    d->redirects = 0;
+    d->startOperation();
     d->setOperation(PostOperation);
     
     bool ok = true;
@@ -602,19 +780,14 @@ void Request::post(bool authRequired) {
     qDebug() << "QSoundCloud::Request::post" << d->url << data;
 #endif
     if (ok) {
-        if (d->reply) {
-            delete d->reply;
-        }
-        
-        d->setStatus(Loading);        
-        d->reply = d->networkAccessManager()->post(d->buildRequest(authRequired), data);
-        connect(d->reply, SIGNAL(finished()), this, SLOT(_q_onReplyFinished()));
+        d->setStatus(Loading);
+        d->schedule(authRequired, data);
     }
     else {
         d->setStatus(Failed);
         d->setError(ParseError);
         d->setErrorString(tr("Unable to serialize the POST data"));
-        emit finished();
+        d->finish();
     }    
 }
 
@@ -629,7 +802,7 @@ void Request::put(bool authRequired) {
         return;
     }
     
-    d->redirects = 0;
+    d->startOperation();
     d->setOperation(PutOperation);
         
     bool ok = true;
@@ -649,19 +822,14 @@ void Request::put(bool authRequired) {
     qDebug() << "QSoundCloud::Request::put" << d->url << data;
 #endif
     if (ok) {
-        if (d->reply) {
-            delete d->reply;
-        }
-        
-        d->setStatus(Loading);        
-        d->reply = d->networkAccessManager()->put(d->buildRequest(authRequired), data);
-        connect(d->reply, SIGNAL(finished()), this, SLOT(_q_onReplyFinished()));
+        d->setStatus(Loading);
+        d->schedule(authRequired, data);
     }
     else {
         d->setStatus(Failed);
         d->setError(ParseError);
         d->setErrorString(tr("Unable to serialize the PUT data"));
-        emit finished();
+        d->finish();
     }    
 }
 
@@ -676,18 +844,13 @@ void Request::deleteResource(bool authRequired) {
         return;
     }
     
-    d->redirects = 0;
+    d->startOperation();
     d->setOperation(DeleteOperation);
     d->setStatus(Loading);
-    
-    if (d->reply) {
-        delete d->reply;
-    }
 #ifdef QSOUNDCLOUD_DEBUG
     qDebug() << "QSoundCloud::Request::deleteResource" << d->url;
 #endif
-    d->reply = d->networkAccessManager()->deleteResource(d->buildRequest(authRequired));
-    connect(d->reply, SIGNAL(finished()), this, SLOT(_q_onReplyFinished()));
+    d->schedule(authRequired);
 }
 
 /*!
@@ -696,9 +859,7 @@ void Request::deleteResource(bool authRequired) {
 void Request::cancel() {
     Q_D(Request);
     
-    if (d->reply) {
-        d->reply->abort();
-    }
+    d->cancel();
 }
 
 RequestPrivate::RequestPrivate(Request *parent) :
@@ -706,15 +867,81 @@ RequestPrivate::RequestPrivate(Request *parent) :
     manager(0),
     reply(0),
     ownNetworkAccessManager(false),
+    refreshingToken(false),
+    waitingForToken(false),
     operation(Request::UnknownOperation),
     status(Request::Null),
     error(Request::NoError),
-    redirects(0)
+    redirects(0),
+    retryPolicy(RetryPolicy::defaultPolicy()),
+    retryTimer(0),
+    retries(0),
+    retryDelay(0),
+    replaying(false),
+    sendAuthRequired(true),
+    dispatchTimer(0),
+    priority(Request::NormalPriority),
+    timeoutPolicy(TimeoutPolicy::defaultPolicy()),
+    replyTimer(0),
+    deadlineTimer(0),
+    replyStarted(0),
+    connecting(false),
+    timedOut(false),
+    parentSpanId(0),
+    parentTraceId(0),
+    bytesSent(0),
+    bytesReceived(0),
+    queued(false),
+    randomState(quint32(QDateTime::currentMSecsSinceEpoch()) ^ quint32(quintptr(parent)))
 {
 }
 
 RequestPrivate::~RequestPrivate() {}
 
+void RequestPrivate::init() {
+    Q_Q(Request);
+    
+    Request::connect(TokenManager::instance(), SIGNAL(refreshed(QString, QString, QString)),
+                     q, SLOT(_q_onTokensRefreshed(QString, QString, QString)));
+    Request::connect(TokenManager::instance(), SIGNAL(refreshFailed(QString, int, QString)),
+                     q, SLOT(_q_onTokenRefreshFailed(QString, int, QString)));
+    
+    const QVariantMap tokens = TokenManager::instance()->storedTokens();
+    
+    if (!tokens.isEmpty()) {
+        clientId = tokens.value("clientId").toString();
+        clientSecret = tokens.value("clientSecret").toString();
+        accessToken = tokens.value("accessToken").toString();
+        refreshToken = tokens.value("refreshToken").toString();
+    }
+}
+
+void RequestPrivate::cancel() {
+    if (reply) {
+        reply->abort();
+    }
+    else if ((waitingForToken) || (queued) || ((retryTimer) && (retryTimer->isActive()))
+             || ((dispatchTimer) && (dispatchTimer->isActive()))) {
+        Q_Q(Request);
+        RequestSchedulerPrivate::release(q);
+        waitingForToken = false;
+        queued = false;
+        
+        if (retryTimer) {
+            retryTimer->stop();
+        }
+        
+        if (dispatchTimer) {
+            dispatchTimer->stop();
+        }
+        
+        setStatus(Request::Canceled);
+        setError(Request::NoError);
+        setErrorString(QString());
+        finish();
+    }
+}
+
 QNetworkAccessManager* RequestPrivate::networkAccessManager() {    
     if (!manager) {
         Q_Q(Request);
@@ -776,6 +1003,8 @@ QNetworkRequest RequestPrivate::buildRequest(QUrl u, bool authRequired) {
 #ifdef QSOUNDCLOUD_DEBUG
     qDebug() << "QSoundCloud::RequestPrivate::buildRequest " << u;
 #endif
+    sentAccessToken.clear();
+    
     if (authRequired) {
 #if QT_VERSION >= 0x050000
         QUrlQuery query(u);
@@ -783,6 +1012,7 @@ QNetworkRequest RequestPrivate::buildRequest(QUrl u, bool authRequired) {
         if (!query.hasQueryItem("client_id")) {
             if (!accessToken.isEmpty()) {
                 query.addQueryItem("oauth_token", accessToken);
+                sentAccessToken = accessToken;
             }
             else {
                 query.addQueryItem("client_id", clientId);
@@ -794,6 +1024,7 @@ QNetworkRequest RequestPrivate::buildRequest(QUrl u, bool authRequired) {
         if (!u.hasQueryItem("client_id")) {
             if (!accessToken.isEmpty()) {
                 u.addQueryItem("oauth_token", accessToken);
+                sentAccessToken = accessToken;
             }
             else {
                 u.addQueryItem("client_id", clientId);
@@ -802,6 +1033,11 @@ QNetworkRequest RequestPrivate::buildRequest(QUrl u, bool authRequired) {
 #endif
     }
     
+    if ((!sentAccessToken.isEmpty()) && (!refreshToken.isEmpty())) {
+        // Only tokens that are in use are refreshed before they expire.
+        TokenManager::instance()->setUsed(refreshToken);
+    }
+    
     QNetworkRequest request(u);
     
     switch (operation) {
@@ -830,10 +1066,106 @@ void RequestPrivate::followRedirect(const QUrl &redirect) {
     }
         
     reply = networkAccessManager()->get(buildRequest(redirect));
+    watchReply();
     Request::connect(reply, SIGNAL(finished()), q, SLOT(_q_onReplyFinished()));
 }
 
+void RequestPrivate::watchReply() {
+    Q_Q(Request);
+    
+    timedOut = false;
+    connecting = false;
+    replyStarted = QDateTime::currentMSecsSinceEpoch();
+    bytesSent = 0;
+    bytesReceived = 0;
+    timings.setConnectionStarted(replyStarted);
+    timings.setEncrypted(0);
+    timings.setRequestSent(0);
+    timings.setFirstByte(0);
+    timings.setLastByte(0);
+    
+    // The reply's signals are connected before its finished() signal is connected by the caller, so the timings 
+    // are recorded before the reply is handled.
+    Request::connect(reply, SIGNAL(metaDataChanged()), q, SLOT(_q_onReplyMetaDataChanged()));
+#if QT_VERSION >= 0x050100
+    Request::connect(reply, SIGNAL(encrypted()), q, SLOT(_q_onReplyEncrypted()));
+#endif
+    Request::connect(reply, SIGNAL(uploadProgress(qint64, qint64)),
+                     q, SLOT(_q_onReplyUploadProgress(qint64, qint64)));
+    Request::connect(reply, SIGNAL(downloadProgress(qint64, qint64)),
+                     q, SLOT(_q_onReplyDownloadProgress(qint64, qint64)));
+    Request::connect(reply, SIGNAL(finished()), q, SLOT(_q_onReplyTransferFinished()));
+    beginReplyTrace();
+    
+    if (replyTimer) {
+        replyTimer->stop();
+    }
+    
+    const int connectTimeout = timeoutPolicy.connectTimeout();
+    const int firstByteTimeout = timeoutPolicy.firstByteTimeout();
+    
+    if ((connectTimeout <= 0) && (firstByteTimeout <= 0)) {
+        return;
+    }
+    
+    int timeout = firstByteTimeout;
+    
+    if (connectTimeout > 0) {
+        // The connection is known to be established once the handshake has finished or the body has been sent.
+        connecting = true;
+        timeout = (firstByteTimeout > 0 ? qMin(connectTimeout, firstByteTimeout) : connectTimeout);
+    }
+    
+    if (!replyTimer) {
+        replyTimer = new QTimer(q);
+        replyTimer->setSingleShot(true);
+        Request::connect(replyTimer, SIGNAL(timeout()), q, SLOT(_q_onReplyTimeout()));
+    }
+    
+    replyTimer->start(timeout);
+}
+
+QNetworkReply::NetworkError RequestPrivate::replyError() const {
+    return timedOut ? QNetworkReply::TimeoutError : reply->error();
+}
+
+QString RequestPrivate::replyErrorString() const {
+    return timedOut ? Request::tr("The request timed out") : reply->errorString();
+}
+
+void RequestPrivate::setTokens(const QString &token, const QString &refresh) {
+    Q_Q(Request);
+    
+    q->setAccessToken(token);
+    q->setRefreshToken(refresh);
+}
+
 void RequestPrivate::refreshAccessToken() {
+    if ((!sentAccessToken.isEmpty()) && (sentAccessToken != accessToken)) {
+        // The access token was refreshed while the request was in progress, so the request is made again.
+        replay();
+        return;
+    }
+    
+    QString token = accessToken;
+    QString refresh = refreshToken;
+    
+    switch (TokenManager::instance()->requestRefresh(sentAccessToken.isEmpty() ? accessToken : sentAccessToken,
+                                                     &token, &refresh)) {
+    case TokenManager::UseRefreshedTokens:
+        setTokens(token, refresh);
+        replay();
+        return;
+    case TokenManager::WaitForRefresh:
+        // Another request is refreshing the token, and the request is made again when it has finished.
+        setTokens(accessToken, refresh);
+        waitingForToken = true;
+        return;
+    default:
+        setTokens(accessToken, refresh);
+        break;
+    }
+    
     Q_Q(Request);
     
     QUrl tokenUrl(TOKEN_URL);
@@ -845,22 +1177,282 @@ void RequestPrivate::refreshAccessToken() {
         delete reply;
     }
     
+    refreshingToken = true;
     reply = networkAccessManager()->post(request, body.toUtf8());
+    watchReply();
     Request::connect(reply, SIGNAL(finished()), q, SLOT(_q_onAccessTokenRefreshed()));
 }
 
+void RequestPrivate::abandonTokenRefresh() {
+    waitingForToken = false;
+    
+    if (refreshingToken) {
+        // Let any requests waiting for the refresh make their own attempt.
+        refreshingToken = false;
+        TokenManager::instance()->failRefresh(refreshToken, Request::OperationCanceledError, QString());
+    }
+}
+
+void RequestPrivate::replay() {
+    Q_Q(Request);
+    
+    // The operation is continued, rather than started again, so the retry count is kept. Credentials are sent only
+    // if the original operation sent them.
+    replaying = true;
+    
+    switch (operation) {
+    case Request::HeadOperation:
+        q->head(sendAuthRequired);
+        break;
+    case Request::GetOperation:
+        q->get(sendAuthRequired);
+        break;
+    case Request::PostOperation:
+        q->post(sendAuthRequired);
+        break;
+    case Request::PutOperation:
+        q->put(sendAuthRequired);
+        break;
+    case Request::DeleteOperation:
+        q->deleteResource(sendAuthRequired);
+        break;
+    default:
+        break;
+    }
+    
+    replaying = false;
+}
+
+void RequestPrivate::schedule(bool authRequired, const QByteArray &body) {
+    if (reply) {
+        delete reply;
+        reply = 0;
+    }
+    
+    sendAuthRequired = authRequired;
+    sendData = body;
+    
+    // A replayed operation continues the span of the original.
+    if (operationSpan.id() == 0) {
+        beginTrace(url);
+    }
+    
+    Q_Q(Request);
+    
+    // Only HEAD and GET requests can safely be stopped and made again when an interactive request needs the slot.
+    if (!RequestSchedulerPrivate::acquire(q, priority, (operation == Request::HeadOperation)
+                                                       || (operation == Request::GetOperation))) {
+        queued = true;
+        return;
+    }
+    
+    dispatch();
+}
+
+void RequestPrivate::dispatch() {
+    const qint64 wait = RateLimiterPrivate::reserve(clientId, url);
+    
+    if (wait <= 0) {
+        send();
+        return;
+    }
+    
+    Q_Q(Request);
+    
+    if (!dispatchTimer) {
+        dispatchTimer = new QTimer(q);
+        dispatchTimer->setSingleShot(true);
+        Request::connect(dispatchTimer, SIGNAL(timeout()), q, SLOT(_q_send()));
+    }
+    
+    dispatchTimer->start(int(wait));
+#ifdef QSOUNDCLOUD_DEBUG
+    qDebug() << "QSoundCloud::RequestPrivate::dispatch" << url << wait;
+#endif
+}
+
+void RequestPrivate::send() {
+    QNetworkAccessManager *nam = networkAccessManager();
+    
+    switch (operation) {
+    case Request::HeadOperation:
+        reply = nam->head(buildRequest(sendAuthRequired));
+        break;
+    case Request::GetOperation:
+        reply = nam->get(buildRequest(sendAuthRequired));
+        break;
+    case Request::PostOperation:
+        reply = nam->post(buildRequest(sendAuthRequired), sendData);
+        break;
+    case Request::PutOperation:
+        reply = nam->put(buildRequest(sendAuthRequired), sendData);
+        break;
+    case Request::DeleteOperation:
+        reply = nam->deleteResource(buildRequest(sendAuthRequired));
+        break;
+    default:
+        return;
+    }
+    
+    Q_Q(Request);
+    
+    sendData.clear();
+    watchReply();
+    Request::connect(reply, SIGNAL(finished()), q, SLOT(_q_onReplyFinished()));
+}
+
+void RequestPrivate::startOperation() {
+    Q_Q(Request);
+    
+    RequestSchedulerPrivate::release(q);
+    queued = false;
+    redirects = 0;
+    abandonTokenRefresh();
+    
+    if (retryTimer) {
+        retryTimer->stop();
+    }
+    
+    if (dispatchTimer) {
+        dispatchTimer->stop();
+    }
+    
+    if (!replaying) {
+        endTrace();
+        retries = 0;
+        retryDelay = 0;
+        timings = RequestTimings();
+        timings.setQueued(QDateTime::currentMSecsSinceEpoch());
+        
+        // The deadline covers the whole operation, so it is not restarted when the request is made again.
+        if (deadlineTimer) {
+            deadlineTimer->stop();
+        }
+        
+        if (timeoutPolicy.deadline() > 0) {
+            if (!deadlineTimer) {
+                deadlineTimer = new QTimer(q);
+                deadlineTimer->setSingleShot(true);
+                Request::connect(deadlineTimer, SIGNAL(timeout()), q, SLOT(_q_onDeadline()));
+            }
+            
+            deadlineTimer->start(timeoutPolicy.deadline());
+        }
+    }
+    
+    replaying = false;
+}
+
+bool RequestPrivate::retry() {
+    if ((!reply) || (retries >= retryPolicy.maximumRetries())) {
+        return false;
+    }
+    
+    if ((operation == Request::PostOperation) && (!retryPolicy.retryNonIdempotent())) {
+        return false;
+    }
+    
+    const int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    
+    switch (replyError()) {
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+        break;
+    default:
+        if ((statusCode != 429) && ((statusCode < 500) || (statusCode > 599))) {
+            return false;
+        }
+        
+        break;
+    }
+    
+    int delay = retryPolicy.delay(retries, random());
+    const qint64 wait = retryAfter();
+    
+    if (wait >= 0) {
+        if (wait > retryPolicy.maximumDelay()) {
+            return false;
+        }
+        
+        delay = qMax(delay, int(wait));
+    }
+    
+    Q_Q(Request);
+    
+    if (!retryTimer) {
+        retryTimer = new QTimer(q);
+        retryTimer->setSingleShot(true);
+        Request::connect(retryTimer, SIGNAL(timeout()), q, SLOT(_q_retry()));
+    }
+    
+    retries++;
+    retryDelay += delay;
+    retryTimer->start(delay);
+    MetricsPrivate::recordRetry();
+#ifdef QSOUNDCLOUD_DEBUG
+    qDebug() << "QSoundCloud::RequestPrivate::retry" << url << replyError() << statusCode << retries << delay;
+#endif
+    return true;
+}
+
+qint64 RequestPrivate::retryAfter() const {
+    if ((!reply) || (!reply->hasRawHeader("Retry-After"))) {
+        return -1;
+    }
+    
+    // Retry-After is either a number of seconds or an HTTP date.
+    const QString value = QString::fromUtf8(reply->rawHeader("Retry-After")).trimmed();
+    bool ok;
+    const qint64 wait = value.toLongLong(&ok) * 1000;
+    
+    if (ok) {
+        return qMax(qint64(0), wait);
+    }
+    
+    QDateTime date = QLocale::c().toDateTime(value.left(25), "ddd, dd MMM yyyy hh:mm:ss");
+    date.setTimeSpec(Qt::UTC);
+    // A value that cannot be parsed is treated as no value, so that the usual backoff applies.
+    return date.isValid() ? qMax(qint64(0), QDateTime::currentDateTime().toUTC().msecsTo(date)) : -1;
+}
+
+void RequestPrivate::reportReply() {
+    // Only the response from the API is reported, and not those from any redirects.
+    if ((!reply) || (redirects > 0)) {
+        return;
+    }
+    
+    const int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    
+    if (statusCode > 0) {
+        RateLimiterPrivate::report(clientId, url, statusCode, qMax(qint64(0), retryAfter()));
+        
+        if (statusCode == 429) {
+            MetricsPrivate::recordRateLimited();
+        }
+    }
+}
+
+qreal RequestPrivate::random() {
+    // xorshift32, which is sufficient for spreading out retries.
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return qreal(randomState) / qreal(0xFFFFFFFFu);
+}
+
 void RequestPrivate::_q_onAccessTokenRefreshed() {
     if (!reply) {
         return;
     }
     
-    Q_Q(Request);
+    refreshingToken = false;
         
     bool ok;
     setResult(QtJson::Json::parse(reply->readAll(), ok));
     
-    const QNetworkReply::NetworkError e = reply->error();
-    const QString es = reply->errorString();
+    const QNetworkReply::NetworkError e = replyError();
+    const QString es = replyErrorString();
     reply->deleteLater();
     reply = 0;
     
@@ -868,57 +1460,398 @@ void RequestPrivate::_q_onAccessTokenRefreshed() {
     case QNetworkReply::NoError:
         break;
     case QNetworkReply::OperationCanceledError:
+        TokenManager::instance()->failRefresh(refreshToken, Request::OperationCanceledError, QString());
         setStatus(Request::Canceled);
         setError(Request::NoError);
         setErrorString(QString());
-        emit q->finished();
+        finish();
         return;
     default:
+        TokenManager::instance()->failRefresh(refreshToken, Request::Error(e), es);
         setStatus(Request::Failed);
         setError(Request::Error(e));
         setErrorString(es);
-        emit q->finished();
+        finish();
         return;
     }
         
     if (ok) {
-        QString token = result.toMap().value("access_token").toString();
+        const QVariantMap tokens = result.toMap();
+        const QString token = tokens.value("access_token").toString();
         
         if (token.isEmpty()) {
+            TokenManager::instance()->failRefresh(refreshToken, Request::ContentAccessDenied,
+                                                  Request::tr("Unable to refresh access token"));
             setStatus(Request::Failed);
             setError(Request::ContentAccessDenied);
             setErrorString(Request::tr("Unable to refresh access token"));
-            emit q->finished();
+            finish();
         }
         else {
-            q->setAccessToken(token);
-            
-            switch (operation) {
-            case Request::GetOperation:
-                q->get();
-                break;
-            case Request::PostOperation:
-                q->post();
-                break;
-            case Request::PutOperation:
-                q->put();
-                break;
-            case Request::DeleteOperation:
-                q->deleteResource();
-                break;
-            default:
-                break;
-            }
+            // The refresh token is replaced if a new one is issued, as the previous one can no longer be used.
+            const QString previous = refreshToken;
+            const QString refresh = tokens.value("refresh_token").toString();
+            setTokens(token, refresh.isEmpty() ? previous : refresh);
+            TokenManager::instance()->finishRefresh(previous, token, refreshToken);
+            TokenManager::instance()->setExpiry(clientId, clientSecret, token, refreshToken,
+                                                tokens.value("expires_in").toInt());
+            replay();
         }
     }
     else {
+        TokenManager::instance()->failRefresh(refreshToken, Request::ParseError,
+                                              Request::tr("Unable to parse response"));
         setStatus(Request::Failed);
         setError(Request::ParseError);
         setErrorString(Request::tr("Unable to parse response"));
-        emit q->finished();
+        finish();
+    }
+}
+
+void RequestPrivate::_q_onTokensRefreshed(const QString &previousRefreshToken, const QString &token,
+                                          const QString &refresh) {
+    if (previousRefreshToken != refreshToken) {
+        return;
+    }
+    
+    setTokens(token, refresh);
+    
+    if (waitingForToken) {
+        waitingForToken = false;
+        replay();
+    }
+}
+
+void RequestPrivate::_q_retry() {
+    replay();
+}
+
+void RequestPrivate::_q_send() {
+    send();
+}
+
+void RequestPrivate::_q_dispatch() {
+    Q_Q(Request);
+    
+    if (RequestSchedulerPrivate::takeDispatched(q)) {
+        queued = false;
+        dispatch();
+    }
+}
+
+void RequestPrivate::connected() {
+    if (!connecting) {
+        return;
+    }
+    
+    connecting = false;
+    const int firstByteTimeout = timeoutPolicy.firstByteTimeout();
+    
+    if (firstByteTimeout > 0) {
+        const qint64 elapsed = QDateTime::currentMSecsSinceEpoch() - replyStarted;
+        replyTimer->start(int(qMax(qint64(0), firstByteTimeout - elapsed)));
+    }
+    else {
+        replyTimer->stop();
+    }
+}
+
+void RequestPrivate::startParse() {
+    timings.setParseStarted(QDateTime::currentMSecsSinceEpoch());
+}
+
+void RequestPrivate::finishParse() {
+    timings.setParseFinished(QDateTime::currentMSecsSinceEpoch());
+}
+
+void RequestPrivate::finish() {
+    Q_Q(Request);
+    
+    timings.setRedirects(redirects);
+    timings.setRetries(retries);
+    timings.setFinished(QDateTime::currentMSecsSinceEpoch());
+    // A slot connected to finished() may start another operation or delete the request, so the state of this
+    // operation is copied before it is emitted, and only the copies are used afterwards.
+    RequestTimings finishedTimings = timings;
+    const QUrl finishedUrl = url;
+    const Request::Operation finishedOperation = operation;
+    const Request::Status finishedStatus = status;
+    TraceSpan span = takeTrace();
+    QPointer<Request> request(q);
+    emit q->finished();
+    // The time taken by the slots connected to finished(), such as those inserting items into a model.
+    finishedTimings.setHandled(QDateTime::currentMSecsSinceEpoch());
+    
+    if ((request) && (timings.finished() == finishedTimings.finished())) {
+        timings.setHandled(finishedTimings.handled());
+    }
+    
+    MetricsPrivate::recordRequest(finishedUrl, finishedOperation, finishedStatus, finishedTimings);
+    
+    if (request) {
+        RequestObserver::notifyFinished(request, finishedTimings);
+    }
+    
+    Tracer::end(&span);
+}
+
+void RequestPrivate::beginTrace(const QUrl &u) {
+    Q_Q(Request);
+    
+    endTrace();
+    const QString className = q->metaObject()->className();
+    QUrl traceUrl(u);
+    removeUrlCredentials(&traceUrl);
+    operationSpan.setKind(TraceSpan::OperationSpan);
+    operationSpan.setName(className.mid(className.lastIndexOf(':') + 1));
+    operationSpan.setMethod(methodName(operation));
+    operationSpan.setUrl(traceUrl);
+    operationSpan.setParentId(parentSpanId);
+    operationSpan.setTraceId(parentTraceId);
+    operationSpan.setStartTime(timings.queued());
+    Tracer::begin(&operationSpan);
+}
+
+void RequestPrivate::endTrace() {
+    TraceSpan span = takeTrace();
+    Tracer::end(&span);
+}
+
+TraceSpan RequestPrivate::takeTrace() {
+    endReplyTrace(false);
+    TraceSpan span = operationSpan;
+    span.setStatus(status);
+    span.setError(error);
+    span.setErrorString(errorString);
+    operationSpan = TraceSpan();
+    return span;
+}
+
+void RequestPrivate::beginReplyTrace() {
+    endReplyTrace(false);
+    
+    // HTTP requests are traced only as part of an operation.
+    if ((!reply) || (operationSpan.id() == 0)) {
+        return;
+    }
+    
+    QString method;
+    
+    switch (reply->operation()) {
+    case QNetworkAccessManager::HeadOperation:
+        method = "HEAD";
+        break;
+    case QNetworkAccessManager::GetOperation:
+        method = "GET";
+        break;
+    case QNetworkAccessManager::PutOperation:
+        method = "PUT";
+        break;
+    case QNetworkAccessManager::PostOperation:
+        method = "POST";
+        break;
+    case QNetworkAccessManager::DeleteOperation:
+        method = "DELETE";
+        break;
+    default:
+        method = QString::fromUtf8(reply->request().attribute(QNetworkRequest::CustomVerbAttribute).toByteArray());
+        break;
+    }
+    
+    QUrl u(reply->url());
+    removeUrlCredentials(&u);
+    replySpan.setKind(TraceSpan::HttpSpan);
+    replySpan.setName("HTTP " + method);
+    replySpan.setMethod(method);
+    replySpan.setUrl(u);
+    replySpan.setParentId(operationSpan.id());
+    replySpan.setTraceId(operationSpan.traceId());
+    replySpan.setStartTime(replyStarted);
+    Tracer::begin(&replySpan);
+}
+
+void RequestPrivate::endReplyTrace(bool completed) {
+    if (replySpan.id() == 0) {
+        return;
+    }
+    
+    if ((completed) && (reply)) {
+        replySpan.setStatusCode(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt());
+        replySpan.setError(Request::Error(replyError()));
+        replySpan.setErrorString(replySpan.error() == Request::NoError ? QString() : replyErrorString());
+    }
+    else {
+        // The reply was abandoned, for example when the request was preempted or its deadline was exceeded.
+        replySpan.setError(Request::OperationCanceledError);
+    }
+    
+    Tracer::end(&replySpan);
+}
+
+QString RequestPrivate::methodName(Request::Operation op) {
+    switch (op) {
+    case Request::HeadOperation:
+        return "HEAD";
+    case Request::GetOperation:
+        return "GET";
+    case Request::PostOperation:
+        return "POST";
+    case Request::PutOperation:
+        return "PUT";
+    case Request::DeleteOperation:
+        return "DELETE";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+void RequestPrivate::_q_onReplyEncrypted() {
+    timings.setEncrypted(QDateTime::currentMSecsSinceEpoch());
+    connected();
+}
+
+void RequestPrivate::_q_onReplyUploadProgress(qint64 bytes, qint64 total) {
+    if (bytes <= 0) {
+        return;
+    }
+    
+    bytesSent = bytes;
+    
+    if (bytes == total) {
+        timings.setRequestSent(QDateTime::currentMSecsSinceEpoch());
+    }
+    
+    connected();
+}
+
+void RequestPrivate::_q_onReplyDownloadProgress(qint64 bytes, qint64) {
+    bytesReceived = bytes;
+}
+
+void RequestPrivate::_q_onReplyMetaDataChanged() {
+    if (timings.firstByte() == 0) {
+        timings.setFirstByte(QDateTime::currentMSecsSinceEpoch());
+    }
+    
+    connecting = false;
+    
+    if (replyTimer) {
+        replyTimer->stop();
     }
 }
 
+void RequestPrivate::_q_onReplyTransferFinished() {
+    timings.setLastByte(QDateTime::currentMSecsSinceEpoch());
+    timings.setBytesSent(timings.bytesSent() + bytesSent);
+    timings.setBytesReceived(timings.bytesReceived() + bytesReceived);
+    bytesSent = 0;
+    bytesReceived = 0;
+    
+    if (replyTimer) {
+        replyTimer->stop();
+    }
+    
+    endReplyTrace(true);
+    
+    if ((reply) && (networkAccessManager()->cache())) {
+        MetricsPrivate::recordCache(MetricsPrivate::HttpCache,
+                                    reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool());
+    }
+}
+
+void RequestPrivate::_q_onReplyTimeout() {
+    if ((!reply) || (reply->isFinished())) {
+        return;
+    }
+#ifdef QSOUNDCLOUD_DEBUG
+    qDebug() << "QSoundCloud::RequestPrivate::_q_onReplyTimeout" << reply->url() << connecting;
+#endif
+    // The reply finishes with OperationCanceledError, which is reported as TimeoutError.
+    timedOut = true;
+    reply->abort();
+}
+
+void RequestPrivate::_q_onDeadline() {
+    if (status != Request::Loading) {
+        return;
+    }
+    
+    Q_Q(Request);
+#ifdef QSOUNDCLOUD_DEBUG
+    qDebug() << "QSoundCloud::RequestPrivate::_q_onDeadline" << url;
+#endif
+    RequestSchedulerPrivate::release(q);
+    abandonTokenRefresh();
+    queued = false;
+    
+    if (retryTimer) {
+        retryTimer->stop();
+    }
+    
+    if (dispatchTimer) {
+        dispatchTimer->stop();
+    }
+    
+    if (replyTimer) {
+        replyTimer->stop();
+    }
+    
+    if (reply) {
+        reply->disconnect(q);
+        reply->abort();
+        reply->deleteLater();
+        reply = 0;
+    }
+    
+    setStatus(Request::Failed);
+    setError(Request::TimeoutError);
+    setErrorString(Request::tr("The request deadline was exceeded"));
+    finish();
+}
+
+void RequestPrivate::_q_preempt() {
+    Q_Q(Request);
+    
+    if (!RequestSchedulerPrivate::takePreempted(q)) {
+        return;
+    }
+#ifdef QSOUNDCLOUD_DEBUG
+    qDebug() << "QSoundCloud::RequestPrivate::_q_preempt" << url;
+#endif
+    // The request is made again when the scheduler has a slot for it.
+    queued = true;
+    
+    if (dispatchTimer) {
+        dispatchTimer->stop();
+    }
+    
+    if (reply) {
+        reply->disconnect(q);
+        reply->abort();
+        reply->deleteLater();
+        reply = 0;
+    }
+}
+
+void RequestPrivate::_q_onTokenRefreshFailed(const QString &token, int e, const QString &es) {
+    if ((!waitingForToken) || (token != refreshToken)) {
+        return;
+    }
+    
+    waitingForToken = false;
+    
+    if (e == Request::OperationCanceledError) {
+        // The request refreshing the token was canceled, so another attempt is made.
+        refreshAccessToken();
+        return;
+    }
+    
+    setStatus(Request::Failed);
+    setError(Request::Error(e));
+    setErrorString(es);
+    finish();
+}
+
 void RequestPrivate::_q_onReplyFinished() {
     if (!reply) {
         return;
@@ -926,6 +1859,15 @@ void RequestPrivate::_q_onReplyFinished() {
     
     Q_Q(Request);
     
+    RequestSchedulerPrivate::release(q);
+    reportReply();
+    
+    if (retry()) {
+        reply->deleteLater();
+        reply = 0;
+        return;
+    }
+    
     if (redirects < MAX_REDIRECTS) {
         QUrl redirect = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toString();
     
@@ -943,10 +1885,12 @@ void RequestPrivate::_q_onReplyFinished() {
     
     bool ok = true;
     const QString response = QString::fromUtf8(reply->readAll());
+    startParse();
     setResult(response.isEmpty() ? response : QtJson::Json::parse(response, ok));
+    finishParse();
     
-    const QNetworkReply::NetworkError e = reply->error();
-    const QString es = reply->errorString();
+    const QNetworkReply::NetworkError e = replyError();
+    const QString es = replyErrorString();
     reply->deleteLater();
     reply = 0;
     
@@ -957,14 +1901,14 @@ void RequestPrivate::_q_onReplyFinished() {
         setStatus(Request::Canceled);
         setError(Request::NoError);
         setErrorString(QString());
-        emit q->finished();
+        finish();
         return;
     case QNetworkReply::AuthenticationRequiredError:
         if (refreshToken.isEmpty()) {
             setStatus(Request::Failed);
             setError(Request::Error(e));
             setErrorString(es);
-            emit q->finished();
+            finish();
         }
         else {
             refreshAccessToken();
@@ -975,7 +1919,7 @@ void RequestPrivate::_q_onReplyFinished() {
         setStatus(Request::Failed);
         setError(Request::Error(e));
         setErrorString(es);
-        emit q->finished();
+        finish();
         return;
     }
     
@@ -990,7 +1934,7 @@ void RequestPrivate::_q_onReplyFinished() {
         setErrorString(Request::tr("Unable to parse response"));
     }
         
-    emit q->finished();
+    finish();
 }
 
 }
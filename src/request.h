@@ -18,6 +18,9 @@
 #define QSOUNDCLOUD_REQUEST_H
 
 #include "qsoundcloud_global.h"
+#include "requesttimings.h"
+#include "retrypolicy.h"
+#include "timeoutpolicy.h"
 #include <QObject>
 #include <QVariantMap>
 
@@ -45,8 +48,11 @@ class QSOUNDCLOUDSHARED_EXPORT Request : public QObject
     Q_PROPERTY(QVariant result READ result NOTIFY finished)
     Q_PROPERTY(Error error READ error NOTIFY finished)
     Q_PROPERTY(QString errorString READ errorString NOTIFY finished)
+    Q_PROPERTY(int retries READ retries NOTIFY finished)
+    Q_PROPERTY(int retryDelay READ retryDelay NOTIFY finished)
+    Q_PROPERTY(Priority priority READ priority WRITE setPriority NOTIFY priorityChanged)
     
-    Q_ENUMS(Operation Status Error)
+    Q_ENUMS(Operation Status Error Priority)
     
 public:
     enum Operation {
@@ -59,6 +65,13 @@ public:
         UnknownOperation = 0
     };
     
+    enum Priority {
+        InteractivePriority = 0,
+        NormalPriority,
+        PrefetchPriority,
+        BackgroundPriority
+    };
+    
     enum Status {
         Null = 0,
         Loading,
@@ -135,6 +148,20 @@ public:
     Error error() const;
     QString errorString() const;
     
+    RetryPolicy retryPolicy() const;
+    void setRetryPolicy(const RetryPolicy &policy);
+    
+    int retries() const;
+    int retryDelay() const;
+    
+    TimeoutPolicy timeoutPolicy() const;
+    void setTimeoutPolicy(const TimeoutPolicy &policy);
+    
+    RequestTimings timings() const;
+    
+    Priority priority() const;
+    void setPriority(Priority p);
+    
     void setNetworkAccessManager(QNetworkAccessManager *manager);
     
 public Q_SLOTS:
@@ -161,6 +188,7 @@ Q_SIGNALS:
     void dataChanged();
     void headersChanged();
     void operationChanged();
+    void priorityChanged();
     void statusChanged(Status s);
     void finished();
     
@@ -172,7 +200,20 @@ protected:
     Q_DECLARE_PRIVATE(Request)
     
     Q_PRIVATE_SLOT(d_func(), void _q_onAccessTokenRefreshed())
+    Q_PRIVATE_SLOT(d_func(), void _q_onTokensRefreshed(QString, QString, QString))
+    Q_PRIVATE_SLOT(d_func(), void _q_onTokenRefreshFailed(QString, int, QString))
     Q_PRIVATE_SLOT(d_func(), void _q_onReplyFinished())
+    Q_PRIVATE_SLOT(d_func(), void _q_retry())
+    Q_PRIVATE_SLOT(d_func(), void _q_send())
+    Q_PRIVATE_SLOT(d_func(), void _q_dispatch())
+    Q_PRIVATE_SLOT(d_func(), void _q_preempt())
+    Q_PRIVATE_SLOT(d_func(), void _q_onReplyEncrypted())
+    Q_PRIVATE_SLOT(d_func(), void _q_onReplyUploadProgress(qint64, qint64))
+    Q_PRIVATE_SLOT(d_func(), void _q_onReplyDownloadProgress(qint64, qint64))
+    Q_PRIVATE_SLOT(d_func(), void _q_onReplyMetaDataChanged())
+    Q_PRIVATE_SLOT(d_func(), void _q_onReplyTransferFinished())
+    Q_PRIVATE_SLOT(d_func(), void _q_onReplyTimeout())
+    Q_PRIVATE_SLOT(d_func(), void _q_onDeadline())
     
 private:
     Q_DISABLE_COPY(Request)
@@ -19,8 +19,10 @@
 
 #include "request.h"
 #include "json.h"
+#include "tracespan.h"
 #include <QUrl>
 #include <QVariantMap>
+#include <QNetworkReply>
 #include <QNetworkRequest>
 #if QT_VERSION >= 0x050000
 #include <QUrlQuery>
@@ -29,7 +31,7 @@
 #include <QDebug>
 #endif
 
-class QNetworkReply;
+class QTimer;
 
 namespace QSoundCloud {
 
@@ -78,6 +80,29 @@ inline void addRequestHeaders(QNetworkRequest *request, const QVariantMap &map)
     }
 }
 
+inline void removeUrlCredentials(QUrl *url) {
+    QUrlQuery query(*url);
+    query.removeAllQueryItems("client_id");
+    query.removeAllQueryItems("oauth_token");
+    url->setQuery(query);
+}
+
+inline QVariantMap urlFilters(const QUrl &url) {
+    // The filters of a query, without the credentials or the position of the page.
+    QVariantMap filters;
+    typedef QPair<QString, QString> QueryItem;
+    
+    foreach (const QueryItem &item, QUrlQuery(url).queryItems(QUrl::FullyDecoded)) {
+        filters[item.first] = item.second;
+    }
+    
+    filters.remove("client_id");
+    filters.remove("oauth_token");
+    filters.remove("cursor");
+    filters.remove("offset");
+    return filters;
+}
+
 inline void addPostBody(QString *body, const QVariantMap &map) {
 #ifdef QSOUNDCLOUD_DEBUG
     qDebug() << "addPostBody:" << body << map;
@@ -151,6 +176,27 @@ inline void addRequestHeaders(QNetworkRequest *request, const QVariantMap &map)
     }
 }
 
+inline void removeUrlCredentials(QUrl *url) {
+    url->removeAllQueryItems("client_id");
+    url->removeAllQueryItems("oauth_token");
+}
+
+inline QVariantMap urlFilters(const QUrl &url) {
+    // The filters of a query, without the credentials or the position of the page.
+    QVariantMap filters;
+    typedef QPair<QString, QString> QueryItem;
+    
+    foreach (const QueryItem &item, url.queryItems()) {
+        filters[item.first] = item.second;
+    }
+    
+    filters.remove("client_id");
+    filters.remove("oauth_token");
+    filters.remove("cursor");
+    filters.remove("offset");
+    return filters;
+}
+
 inline void addPostBody(QString *body, const QVariantMap &map) {
 #ifdef QSOUNDCLOUD_DEBUG
     qDebug() << "addPostBody:" << body << map;
@@ -187,8 +233,12 @@ public:
     RequestPrivate(Request *parent);
     virtual ~RequestPrivate();
     
+    void init();
+    
     QNetworkAccessManager* networkAccessManager();
     
+    virtual void cancel();
+    
     void setOperation(Request::Operation op);
     
     void setStatus(Request::Status s);
@@ -204,8 +254,58 @@ public:
     
     virtual void followRedirect(const QUrl &redirect);
     
+    void watchReply();
+    void connected();
+    QNetworkReply::NetworkError replyError() const;
+    QString replyErrorString() const;
+    
+    void setTokens(const QString &token, const QString &refresh);
+    
     void refreshAccessToken();
+    void abandonTokenRefresh();
+    
+    void replay();
+    
+    void startParse();
+    void finishParse();
+    
+    void finish();
+    
+    void beginTrace(const QUrl &u);
+    void endTrace();
+    TraceSpan takeTrace();
+    void beginReplyTrace();
+    void endReplyTrace(bool completed);
+    
+    static QString methodName(Request::Operation op);
+    
+    void schedule(bool authRequired, const QByteArray &body = QByteArray());
+    void dispatch();
+    void send();
+    
+    void startOperation();
+    
+    bool retry();
+    qint64 retryAfter() const;
+    void reportReply();
+    qreal random();
+    
     void _q_onAccessTokenRefreshed();
+    void _q_onTokensRefreshed(const QString &previousRefreshToken, const QString &token, const QString &refresh);
+    void _q_onTokenRefreshFailed(const QString &token, int e, const QString &es);
+    
+    void _q_retry();
+    void _q_send();
+    void _q_dispatch();
+    void _q_preempt();
+    
+    void _q_onReplyEncrypted();
+    void _q_onReplyUploadProgress(qint64 bytes, qint64 total);
+    void _q_onReplyDownloadProgress(qint64 bytes, qint64 total);
+    void _q_onReplyMetaDataChanged();
+    void _q_onReplyTransferFinished();
+    void _q_onReplyTimeout();
+    virtual void _q_onDeadline();
         
     virtual void _q_onReplyFinished();
     
@@ -221,6 +321,11 @@ public:
     QString clientSecret;
     QString accessToken;
     QString refreshToken;
+    
+    QString sentAccessToken;
+    
+    bool refreshingToken;
+    bool waitingForToken;
         
     QUrl url;
     
@@ -240,6 +345,47 @@ public:
     
     int redirects;
     
+    RetryPolicy retryPolicy;
+    
+    QTimer *retryTimer;
+    
+    int retries;
+    int retryDelay;
+    
+    bool replaying;
+    
+    bool sendAuthRequired;
+    QByteArray sendData;
+    
+    QTimer *dispatchTimer;
+    
+    Request::Priority priority;
+    
+    TimeoutPolicy timeoutPolicy;
+    
+    QTimer *replyTimer;
+    QTimer *deadlineTimer;
+    
+    qint64 replyStarted;
+    
+    bool connecting;
+    bool timedOut;
+    
+    RequestTimings timings;
+    
+    TraceSpan operationSpan;
+    TraceSpan replySpan;
+    
+    quint64 parentSpanId;
+    quint64 parentTraceId;
+    
+    qint64 bytesSent;
+    qint64 bytesReceived;
+    
+    bool queued;
+    
+    quint32 randomState;
+    
     Q_DECLARE_PUBLIC(Request)
 };
 
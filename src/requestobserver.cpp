@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "requestobserver.h"
+#include <QList>
+#include <QMutex>
+
+namespace QSoundCloud {
+
+class RequestObservers
+{
+
+public:
+    QMutex mutex;
+    
+    QList<RequestObserver*> observers;
+};
+
+Q_GLOBAL_STATIC(RequestObservers, requestObservers)
+
+/*!
+    \class RequestObserver
+    \brief The base class for observing every request made by the library.
+    
+    \ingroup requests
+    
+    A RequestObserver that has been added using addObserver() is notified when any Request finishes, with the 
+    RequestTimings of the request. This can be used to log slow requests, or to collect statistics, without 
+    connecting to each request.
+    
+    requestFinished() is called in the thread of the request, after every slot connected to Request::finished() has 
+    returned, so implementations must be thread-safe if requests are made in more than one thread, such as by 
+    Client. It is not called if one of those slots deleted the request, and the timings are those of the operation 
+    that finished, even if one of those slots started another operation. The observer is not owned by the library, 
+    and must be removed using removeObserver() before it is deleted.
+    
+    Example usage:
+    
+    \code
+    class SlowRequestLogger : public QSoundCloud::RequestObserver
+    {
+    
+    public:
+        void requestFinished(QSoundCloud::Request *request, const QSoundCloud::RequestTimings &timings) {
+            if (timings.totalTime() > 1000) {
+                qDebug() << request->url() << timings.networkTime() << timings.parseTime() << timings.handlingTime();
+            }
+        }
+    };
+    
+    SlowRequestLogger logger;
+    QSoundCloud::RequestObserver::addObserver(&logger);
+    \endcode
+    
+    \sa Request::timings()
+*/
+RequestObserver::~RequestObserver() {}
+
+/*!
+    \fn void RequestObserver::requestFinished(Request *request, const RequestTimings &timings)
+    \brief Called when \a request has finished, with its \a timings.
+*/
+
+/*!
+    \brief Adds \a observer to the observers notified of every request.
+*/
+void RequestObserver::addObserver(RequestObserver *observer) {
+    RequestObservers *d = requestObservers();
+    QMutexLocker locker(&d->mutex);
+    
+    if (!d->observers.contains(observer)) {
+        d->observers << observer;
+    }
+}
+
+/*!
+    \brief Removes \a observer from the observers notified of every request.
+*/
+void RequestObserver::removeObserver(RequestObserver *observer) {
+    RequestObservers *d = requestObservers();
+    QMutexLocker locker(&d->mutex);
+    d->observers.removeOne(observer);
+}
+
+void RequestObserver::notifyFinished(Request *request, const RequestTimings &timings) {
+    RequestObservers *d = requestObservers();
+    QMutexLocker locker(&d->mutex);
+    
+    if (d->observers.isEmpty()) {
+        return;
+    }
+    
+    const QList<RequestObserver*> observers = d->observers;
+    locker.unlock();
+    
+    foreach (RequestObserver *observer, observers) {
+        observer->requestFinished(request, timings);
+    }
+}
+
+}
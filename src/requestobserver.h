@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QSOUNDCLOUD_REQUESTOBSERVER_H
+#define QSOUNDCLOUD_REQUESTOBSERVER_H
+
+#include "requesttimings.h"
+
+namespace QSoundCloud {
+
+class Request;
+
+class QSOUNDCLOUDSHARED_EXPORT RequestObserver
+{
+
+public:
+    virtual ~RequestObserver();
+    
+    virtual void requestFinished(Request *request, const RequestTimings &timings) = 0;
+    
+    static void addObserver(RequestObserver *observer);
+    static void removeObserver(RequestObserver *observer);
+
+private:
+    static void notifyFinished(Request *request, const RequestTimings &timings);
+    
+    friend class RequestPrivate;
+};
+
+}
+
+#endif // QSOUNDCLOUD_REQUESTOBSERVER_H
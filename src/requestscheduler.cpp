@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "requestscheduler_p.h"
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#ifdef QSOUNDCLOUD_DEBUG
+#include <QDebug>
+#endif
+
+namespace QSoundCloud {
+
+static const int PRIORITIES = Request::BackgroundPriority + 1;
+
+class RequestQueue
+{
+
+public:
+    RequestQueue() :
+        maximumTotal(0)
+    {
+        // No limits are set by default, so requests are scheduled only once the application sets them.
+        for (int i = 0; i < PRIORITIES; i++) {
+            maximumActive[i] = 0;
+        }
+    }
+    
+    int totalActive() const {
+        int total = 0;
+        
+        for (int i = 0; i < PRIORITIES; i++) {
+            total += active[i].size();
+        }
+        
+        return total;
+    }
+    
+    bool canStart(int priority) const {
+        if ((maximumActive[priority] > 0) && (active[priority].size() >= maximumActive[priority])) {
+            return false;
+        }
+        
+        // Interactive requests are limited only by their own class, and lower classes make way for them.
+        if (priority == Request::InteractivePriority) {
+            return true;
+        }
+        
+        if (maximumTotal <= 0) {
+            return true;
+        }
+        
+        if (totalActive() >= maximumTotal) {
+            return false;
+        }
+        
+        // Prefetch and background requests are postponed while there are interactive requests.
+        if ((priority >= Request::PrefetchPriority) && ((!active[Request::InteractivePriority].isEmpty())
+                                                        || (!queued[Request::InteractivePriority].isEmpty()))) {
+            return false;
+        }
+        
+        return true;
+    }
+    
+    void remove(Request *request) {
+        const int priority = priorities.take(request);
+        active[priority].removeOne(request);
+        queued[priority].removeOne(request);
+        preemptible.remove(request);
+        preempted.remove(request);
+        dispatched.remove(request);
+    }
+    
+    void dispatch() {
+        for (int i = 0; i < PRIORITIES; i++) {
+            while ((!queued[i].isEmpty()) && (canStart(i))) {
+                Request *request = queued[i].takeFirst();
+                active[i] << request;
+                dispatched.insert(request);
+                // The request may belong to another thread, so it is started by a queued call. The mutex is held,
+                // so the request cannot be deleted before the call is posted.
+                QMetaObject::invokeMethod(request, "_q_dispatch", Qt::QueuedConnection);
+                
+                if (i == Request::InteractivePriority) {
+                    preempt();
+                }
+            }
+        }
+    }
+    
+    void preempt() {
+        if ((maximumTotal <= 0) || (totalActive() <= maximumTotal)) {
+            return;
+        }
+        
+        for (int i = Request::BackgroundPriority; i >= Request::PrefetchPriority; i--) {
+            for (int j = active[i].size() - 1; j >= 0; j--) {
+                Request *request = active[i].at(j);
+                
+                if (preemptible.contains(request)) {
+                    // The most recently started request has the least to lose, and is the first to be made again.
+                    active[i].removeAt(j);
+                    queued[i].prepend(request);
+                    dispatched.remove(request);
+                    preempted.insert(request);
+                    QMetaObject::invokeMethod(request, "_q_preempt", Qt::QueuedConnection);
+#ifdef QSOUNDCLOUD_DEBUG
+                    qDebug() << "QSoundCloud::RequestQueue::preempt" << request;
+#endif
+                    return;
+                }
+            }
+        }
+    }
+    
+    QMutex mutex;
+    
+    int maximumActive[PRIORITIES];
+    int maximumTotal;
+    
+    QList<Request*> active[PRIORITIES];
+    QList<Request*> queued[PRIORITIES];
+    
+    QHash<Request*, int> priorities;
+    
+    QSet<Request*> preemptible;
+    QSet<Request*> preempted;
+    QSet<Request*> dispatched;
+};
+
+Q_GLOBAL_STATIC(RequestQueue, requestQueue)
+
+bool RequestSchedulerPrivate::acquire(Request *request, Request::Priority priority, bool preemptible) {
+    RequestQueue *queue = requestQueue();
+    QMutexLocker locker(&queue->mutex);
+    queue->remove(request);
+    queue->priorities[request] = priority;
+    
+    if (preemptible) {
+        queue->preemptible.insert(request);
+    }
+    
+    if ((queue->queued[priority].isEmpty()) && (queue->canStart(priority))) {
+        queue->active[priority] << request;
+        
+        if (priority == Request::InteractivePriority) {
+            queue->preempt();
+        }
+        
+        return true;
+    }
+    
+    queue->queued[priority] << request;
+#ifdef QSOUNDCLOUD_DEBUG
+    qDebug() << "QSoundCloud::RequestSchedulerPrivate::acquire: Request queued" << request << priority;
+#endif
+    return false;
+}
+
+void RequestSchedulerPrivate::release(Request *request) {
+    RequestQueue *queue = requestQueue();
+    QMutexLocker locker(&queue->mutex);
+    
+    if (queue->priorities.contains(request)) {
+        queue->remove(request);
+        queue->dispatch();
+    }
+}
+
+bool RequestSchedulerPrivate::takeDispatched(Request *request) {
+    RequestQueue *queue = requestQueue();
+    QMutexLocker locker(&queue->mutex);
+    return queue->dispatched.remove(request);
+}
+
+bool RequestSchedulerPrivate::takePreempted(Request *request) {
+    RequestQueue *queue = requestQueue();
+    QMutexLocker locker(&queue->mutex);
+    return queue->preempted.remove(request);
+}
+
+/*!
+    \class RequestScheduler
+    \brief Limits the number of requests that are made at the same time, according to their priority.
+    
+    \ingroup requests
+    
+    Each Request has a priority, and the number of requests of each priority that can be in progress at the same
+    time can be limited. A request that would exceed the limit waits, with the status Loading, until another request of
+    its priority has finished. Waiting requests are started in order of priority, and in the order in which they
+    were made within each priority.
+    
+    Apart from Request::InteractivePriority, requests are also limited by maximumTotalActiveRequests(). Once that
+    limit is set, requests of Request::PrefetchPriority and Request::BackgroundPriority are postponed while there are
+    interactive requests. If an interactive request would exceed the total, a prefetch or background HEAD or GET
+    request in progress is stopped and made again later, so that interactive requests are not kept waiting by bulk
+    transfers.
+    
+    By default there are no limits, and every request is started at once.
+    
+    Example usage:
+    
+    \code
+    QSoundCloud::RequestScheduler::setMaximumTotalActiveRequests(6);
+    QSoundCloud::RequestScheduler::setMaximumActiveRequests(QSoundCloud::Request::PrefetchPriority, 2);
+    \endcode
+    
+    \sa Request::priority
+*/
+
+/*!
+    \brief Returns the maximum number of requests of \a priority that can be in progress at the same time.
+    
+    A value of 0 means that there is no limit.
+*/
+int RequestScheduler::maximumActiveRequests(Request::Priority priority) {
+    RequestQueue *queue = requestQueue();
+    QMutexLocker locker(&queue->mutex);
+    return queue->maximumActive[priority];
+}
+
+/*!
+    \brief Sets the maximum number of requests of \a priority that can be in progress at the same time to
+    \a maximum.
+    
+    A \a maximum of 0 removes the limit.
+*/
+void RequestScheduler::setMaximumActiveRequests(Request::Priority priority, int maximum) {
+    RequestQueue *queue = requestQueue();
+    QMutexLocker locker(&queue->mutex);
+    queue->maximumActive[priority] = qMax(0, maximum);
+    queue->dispatch();
+}
+
+/*!
+    \brief Returns the maximum number of requests that can be in progress at the same time.
+    
+    Interactive requests can exceed this limit. A value of 0 means that there is no limit.
+*/
+int RequestScheduler::maximumTotalActiveRequests() {
+    RequestQueue *queue = requestQueue();
+    QMutexLocker locker(&queue->mutex);
+    return queue->maximumTotal;
+}
+
+/*!
+    \brief Sets the maximum number of requests that can be in progress at the same time to \a maximum.
+    
+    A \a maximum of 0 removes the limit.
+*/
+void RequestScheduler::setMaximumTotalActiveRequests(int maximum) {
+    RequestQueue *queue = requestQueue();
+    QMutexLocker locker(&queue->mutex);
+    queue->maximumTotal = qMax(0, maximum);
+    queue->dispatch();
+}
+
+/*!
+    \brief Returns the number of requests of \a priority that are in progress.
+*/
+int RequestScheduler::activeRequests(Request::Priority priority) {
+    RequestQueue *queue = requestQueue();
+    QMutexLocker locker(&queue->mutex);
+    return queue->active[priority].size();
+}
+
+/*!
+    \brief Returns the number of requests of \a priority that are waiting to be started.
+*/
+int RequestScheduler::queuedRequests(Request::Priority priority) {
+    RequestQueue *queue = requestQueue();
+    QMutexLocker locker(&queue->mutex);
+    return queue->queued[priority].size();
+}
+
+}
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "requesttimings.h"
+
+namespace QSoundCloud {
+
+/*!
+    \class RequestTimings
+    \brief Records how long each phase of a request took.
+    
+    \ingroup requests
+    
+    Each time is in milliseconds since the epoch, or 0 if the phase was not reached. The phases from 
+    connectionStarted to lastByte are those of the last HTTP request made, after any retries and redirects, while 
+    queued, the byte counts, redirects and retries cover the whole operation.
+    
+    Qt does not report when a connection is established, so encrypted is set only for HTTPS requests with Qt 5.1 or 
+    later on a new connection, and requestSent only for requests with a body.
+    
+    The durations networkTime(), parseTime() and handlingTime() show whether a slow request was caused by the 
+    network, by parsing the response, or by the slots connected to Request::finished(), such as the insertion of 
+    items into a model.
+    
+    \sa Request::timings(), RequestObserver
+*/
+RequestTimings::RequestTimings() :
+    m_queued(0),
+    m_connectionStarted(0),
+    m_encrypted(0),
+    m_requestSent(0),
+    m_firstByte(0),
+    m_lastByte(0),
+    m_parseStarted(0),
+    m_parseFinished(0),
+    m_finished(0),
+    m_handled(0),
+    m_bytesSent(0),
+    m_bytesReceived(0),
+    m_redirects(0),
+    m_retries(0)
+{
+}
+
+/*!
+    \brief Returns the time at which the operation was started, before it waited for a slot or a rate limit.
+*/
+qint64 RequestTimings::queued() const {
+    return m_queued;
+}
+
+/*!
+    \brief Sets the time at which the operation was started, before it waited for a slot or a rate limit to \a time.
+*/
+void RequestTimings::setQueued(qint64 time) {
+    m_queued = time;
+}
+
+/*!
+    \brief Returns the time at which the last HTTP request was passed to the QNetworkAccessManager.
+*/
+qint64 RequestTimings::connectionStarted() const {
+    return m_connectionStarted;
+}
+
+/*!
+    \brief Sets the time at which the last HTTP request was passed to the QNetworkAccessManager to \a time.
+*/
+void RequestTimings::setConnectionStarted(qint64 time) {
+    m_connectionStarted = time;
+}
+
+/*!
+    \brief Returns the time at which the TLS handshake of the last HTTP request finished.
+*/
+qint64 RequestTimings::encrypted() const {
+    return m_encrypted;
+}
+
+/*!
+    \brief Sets the time at which the TLS handshake of the last HTTP request finished to \a time.
+*/
+void RequestTimings::setEncrypted(qint64 time) {
+    m_encrypted = time;
+}
+
+/*!
+    \brief Returns the time at which the body of the last HTTP request was sent.
+*/
+qint64 RequestTimings::requestSent() const {
+    return m_requestSent;
+}
+
+/*!
+    \brief Sets the time at which the body of the last HTTP request was sent to \a time.
+*/
+void RequestTimings::setRequestSent(qint64 time) {
+    m_requestSent = time;
+}
+
+/*!
+    \brief Returns the time at which the response headers of the last HTTP request were received.
+*/
+qint64 RequestTimings::firstByte() const {
+    return m_firstByte;
+}
+
+/*!
+    \brief Sets the time at which the response headers of the last HTTP request were received to \a time.
+*/
+void RequestTimings::setFirstByte(qint64 time) {
+    m_firstByte = time;
+}
+
+/*!
+    \brief Returns the time at which the response of the last HTTP request was received.
+*/
+qint64 RequestTimings::lastByte() const {
+    return m_lastByte;
+}
+
+/*!
+    \brief Sets the time at which the response of the last HTTP request was received to \a time.
+*/
+void RequestTimings::setLastByte(qint64 time) {
+    m_lastByte = time;
+}
+
+/*!
+    \brief Returns the time at which parsing of the response started.
+*/
+qint64 RequestTimings::parseStarted() const {
+    return m_parseStarted;
+}
+
+/*!
+    \brief Sets the time at which parsing of the response started to \a time.
+*/
+void RequestTimings::setParseStarted(qint64 time) {
+    m_parseStarted = time;
+}
+
+/*!
+    \brief Returns the time at which parsing of the response finished.
+*/
+qint64 RequestTimings::parseFinished() const {
+    return m_parseFinished;
+}
+
+/*!
+    \brief Sets the time at which parsing of the response finished to \a time.
+*/
+void RequestTimings::setParseFinished(qint64 time) {
+    m_parseFinished = time;
+}
+
+/*!
+    \brief Returns the time at which the Request::finished() signal was emitted.
+*/
+qint64 RequestTimings::finished() const {
+    return m_finished;
+}
+
+/*!
+    \brief Sets the time at which the Request::finished() signal was emitted to \a time.
+*/
+void RequestTimings::setFinished(qint64 time) {
+    m_finished = time;
+}
+
+/*!
+    \brief Returns the time at which every slot connected to the Request::finished() signal had returned.
+*/
+qint64 RequestTimings::handled() const {
+    return m_handled;
+}
+
+/*!
+    \brief Sets the time at which every slot connected to the Request::finished() signal had returned to \a time.
+*/
+void RequestTimings::setHandled(qint64 time) {
+    m_handled = time;
+}
+
+/*!
+    \brief Returns the number of bytes sent in the bodies of all HTTP requests.
+*/
+qint64 RequestTimings::bytesSent() const {
+    return m_bytesSent;
+}
+
+/*!
+    \brief Sets the number of bytes sent in the bodies of all HTTP requests to \a bytes.
+*/
+void RequestTimings::setBytesSent(qint64 bytes) {
+    m_bytesSent = bytes;
+}
+
+/*!
+    \brief Returns the number of bytes received in the bodies of all HTTP responses.
+*/
+qint64 RequestTimings::bytesReceived() const {
+    return m_bytesReceived;
+}
+
+/*!
+    \brief Sets the number of bytes received in the bodies of all HTTP responses to \a bytes.
+*/
+void RequestTimings::setBytesReceived(qint64 bytes) {
+    m_bytesReceived = bytes;
+}
+
+/*!
+    \brief Returns the number of redirects that were followed.
+*/
+int RequestTimings::redirects() const {
+    return m_redirects;
+}
+
+/*!
+    \brief Sets the number of redirects that were followed to \a count.
+*/
+void RequestTimings::setRedirects(int count) {
+    m_redirects = count;
+}
+
+/*!
+    \brief Returns the number of times that the request was retried.
+*/
+int RequestTimings::retries() const {
+    return m_retries;
+}
+
+/*!
+    \brief Sets the number of times that the request was retried to \a count.
+*/
+void RequestTimings::setRetries(int count) {
+    m_retries = count;
+}
+
+/*!
+    \brief Returns the time in milliseconds from the start of the last HTTP request until its response was 
+    received, or -1 if it was not received.
+*/
+qint64 RequestTimings::networkTime() const {
+    return (m_connectionStarted > 0) && (m_lastByte > 0) ? m_lastByte - m_connectionStarted : -1;
+}
+
+/*!
+    \brief Returns the time in milliseconds taken to parse the response, or -1 if it was not parsed.
+*/
+qint64 RequestTimings::parseTime() const {
+    return (m_parseStarted > 0) && (m_parseFinished > 0) ? m_parseFinished - m_parseStarted : -1;
+}
+
+/*!
+    \brief Returns the time in milliseconds taken by the slots connected to Request::finished(), or -1 if the 
+    request has not finished.
+*/
+qint64 RequestTimings::handlingTime() const {
+    return (m_finished > 0) && (m_handled > 0) ? m_handled - m_finished : -1;
+}
+
+/*!
+    \brief Returns the time in milliseconds from the start of the operation until the request finished, or -1 if 
+    the request has not finished.
+*/
+qint64 RequestTimings::totalTime() const {
+    return (m_queued > 0) && (m_finished > 0) ? m_finished - m_queued : -1;
+}
+
+}
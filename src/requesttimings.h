@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QSOUNDCLOUD_REQUESTTIMINGS_H
+#define QSOUNDCLOUD_REQUESTTIMINGS_H
+
+#include "qsoundcloud_global.h"
+
+namespace QSoundCloud {
+
+class QSOUNDCLOUDSHARED_EXPORT RequestTimings
+{
+
+public:
+    RequestTimings();
+    
+    qint64 queued() const;
+    void setQueued(qint64 time);
+    
+    qint64 connectionStarted() const;
+    void setConnectionStarted(qint64 time);
+    
+    qint64 encrypted() const;
+    void setEncrypted(qint64 time);
+    
+    qint64 requestSent() const;
+    void setRequestSent(qint64 time);
+    
+    qint64 firstByte() const;
+    void setFirstByte(qint64 time);
+    
+    qint64 lastByte() const;
+    void setLastByte(qint64 time);
+    
+    qint64 parseStarted() const;
+    void setParseStarted(qint64 time);
+    
+    qint64 parseFinished() const;
+    void setParseFinished(qint64 time);
+    
+    qint64 finished() const;
+    void setFinished(qint64 time);
+    
+    qint64 handled() const;
+    void setHandled(qint64 time);
+    
+    qint64 bytesSent() const;
+    void setBytesSent(qint64 bytes);
+    
+    qint64 bytesReceived() const;
+    void setBytesReceived(qint64 bytes);
+    
+    int redirects() const;
+    void setRedirects(int count);
+    
+    int retries() const;
+    void setRetries(int count);
+    
+    qint64 networkTime() const;
+    qint64 parseTime() const;
+    qint64 handlingTime() const;
+    qint64 totalTime() const;
+
+private:
+    qint64 m_queued;
+    qint64 m_connectionStarted;
+    qint64 m_encrypted;
+    qint64 m_requestSent;
+    qint64 m_firstByte;
+    qint64 m_lastByte;
+    qint64 m_parseStarted;
+    qint64 m_parseFinished;
+    qint64 m_finished;
+    qint64 m_handled;
+    
+    qint64 m_bytesSent;
+    qint64 m_bytesReceived;
+    int m_redirects;
+    int m_retries;
+};
+
+}
+
+#endif // QSOUNDCLOUD_REQUESTTIMINGS_H
@@ -15,13 +15,95 @@
  */
 
 #include "resourcesmodel.h"
+#include "metrics_p.h"
 #include "model_p.h"
+#include "request_p.h"
 #ifdef QSOUNDCLOUD_DEBUG
 #include <QDebug>
 #endif
 
 namespace QSoundCloud {
 
+static const int MAX_CONCURRENT_WRITES = 4;
+
+class ResourcesPage
+{
+
+public:
+    ResourcesPage(int first = 0, int count = 0, const QVariantMap &filters = QVariantMap(),
+                  const QString &href = QString()) :
+        first(first),
+        count(count),
+        filters(filters),
+        href(href),
+        resident(true),
+        failed(false)
+    {
+    }
+    
+    int first;
+    int count;
+    
+    QVariantMap filters;
+    QString href;
+    
+    bool resident;
+    bool failed;
+};
+
+class ResourcesFetch
+{
+
+public:
+    ResourcesFetch(int index = 0, const QVariantMap &filters = QVariantMap(), const QString &href = QString()) :
+        index(index),
+        filters(filters),
+        href(href)
+    {
+    }
+    
+    int index;
+    
+    QVariantMap filters;
+    QString href;
+    
+    QVariantMap result;
+};
+
+class ResourcesWrite
+{
+
+public:
+    enum Operation {
+        Insert = 0,
+        InsertItem,
+        Update,
+        Delete
+    };
+    
+    ResourcesWrite(Operation operation = Insert, const QString &url = QString(), const QString &listPath = QString()) :
+        operation(operation),
+        url(url),
+        listPath(listPath),
+        row(-1),
+        applied(false)
+    {
+    }
+    
+    Operation operation;
+    
+    QString url;
+    QString listPath;
+    QString id;
+    
+    QVariantMap resource;
+    QVariantMap previous;
+    
+    int row;
+    
+    bool applied;
+};
+
 class ResourcesModelPrivate : public ModelPrivate
 {
 
@@ -29,136 +111,876 @@ public:
     ResourcesModelPrivate(ResourcesModel *parent) :
         ModelPrivate(parent),
         request(0),
-        hasMore(false)
+        statusFromRequest(true),
+        lastStatus(ResourcesRequest::Null),
+        lastError(ResourcesRequest::NoError),
+        pageRequest(0),
+        prefetchRequest(0),
+        manager(0),
+        deletedRowsScheduled(false),
+        hasMore(false),
+        residentPages(0),
+        accessFirst(-1),
+        accessLast(-1),
+        windowFirst(-1),
+        windowLast(-1),
+        loadingPage(-1),
+        windowUpdateScheduled(false),
+        prefetchDistance(0),
+        prefetching(false),
+        prefetched(false),
+        fetchMoreOnPrefetch(false),
+        prefetchScheduled(false),
+        fetchingAll(false),
+        fetchAllConcurrency(1),
+        fetchAllNext(0),
+        fetchAllFlushed(0),
+        fetchAllEnd(-1)
     {
     }
+    
+    ResourcesRequest* createRequest(const char *member) {
+        Q_Q(ResourcesModel);
+        
+        ResourcesRequest *r = new ResourcesRequest(q);
+        
+        if (manager) {
+            r->setNetworkAccessManager(manager);
+        }
+        
+        ResourcesModel::connect(r, SIGNAL(finished()), q, member);
+        return r;
+    }
+    
+    void setLastStatus(ResourcesRequest *r) {
+        // Pooled requests are reused, so the status of the model is copied from them rather than read from them.
+        statusFromRequest = false;
+        lastStatus = r->status();
+        lastResult = r->result();
+        lastError = r->error();
+        lastErrorString = r->errorString();
+    }
+    
+    void copyCredentials(ResourcesRequest *r) const {
+        r->setClientId(request->clientId());
+        r->setClientSecret(request->clientSecret());
+        r->setAccessToken(request->accessToken());
+        r->setRefreshToken(request->refreshToken());
+    }
+    
+    static QVariantList resultItems(const QVariantMap &result) {
+        return result.contains("collection") ? result.value("collection").toList() : result.value("list").toList();
+    }
+    
+    QVariantMap nextPageFilters() const {
+        QVariantMap next = filters;
+        const int page = next.value("page").toInt();
+        next["page"] = (page > 0 ? page + 1 : 2);
+        return next;
+    }
+    
+    int pageOf(int row) const {
+        int lower = 0;
+        int upper = pages.size() - 1;
+        
+        while (lower <= upper) {
+            const int middle = (lower + upper) / 2;
+            const ResourcesPage &page = pages.at(middle);
+            
+            if (row < page.first) {
+                upper = middle - 1;
+            }
+            else if (row >= page.first + page.count) {
+                lower = middle + 1;
+            }
+            else {
+                return middle;
+            }
+        }
+        
+        return -1;
+    }
+    
+    int windowStart() const {
+        const int extra = qMax(0, residentPages - (windowLast - windowFirst + 1));
+        return qMax(0, windowFirst - extra / 2);
+    }
+    
+    int windowEnd() const {
+        return qMax(windowLast, windowStart() + residentPages - 1);
+    }
+    
+    bool inWindow(int i) const {
+        return (i >= windowStart()) && (i <= windowEnd());
+    }
+    
+    void itemAccessed(int row) {
+        if ((prefetchDistance > 0) && (row >= count - prefetchDistance) && (!prefetchScheduled)) {
+            Q_Q(ResourcesModel);
+            prefetchScheduled = true;
+            QMetaObject::invokeMethod(q, "_q_prefetch", Qt::QueuedConnection);
+        }
+        
+        if (residentPages <= 0) {
+            return;
+        }
+        
+        const int page = pageOf(row);
+        
+        if (page == -1) {
+            return;
+        }
+        
+        // The pages read by views until the next pass of the event loop are taken to be those that are visible.
+        if (accessFirst == -1) {
+            accessFirst = page;
+            accessLast = page;
+        }
+        else {
+            accessFirst = qMin(accessFirst, page);
+            accessLast = qMax(accessLast, page);
+        }
         
+        if (!windowUpdateScheduled) {
+            Q_Q(ResourcesModel);
+            windowUpdateScheduled = true;
+            QMetaObject::invokeMethod(q, "_q_updateWindow", Qt::QueuedConnection);
+        }
+    }
+    
+    void itemsInserted(int row, int n) {
+        for (int i = 0; i < pages.size(); i++) {
+            ResourcesPage &page = pages[i];
+            
+            if (page.first >= row) {
+                page.first += n;
+            }
+            else if (row < page.first + page.count) {
+                page.count += n;
+            }
+        }
+    }
+    
+    void itemsRemoved(int row, int n) {
+        const int end = row + n;
+        
+        for (int i = 0; i < pages.size(); i++) {
+            ResourcesPage &page = pages[i];
+            const int pageEnd = page.first + page.count;
+            
+            if (pageEnd <= row) {
+                continue;
+            }
+            
+            if (page.first >= end) {
+                page.first -= n;
+            }
+            else {
+                page.count -= qMin(pageEnd, end) - qMax(page.first, row);
+                page.first = qMin(page.first, row);
+            }
+        }
+    }
+    
+    void itemsCleared() {
+        pages.clear();
+        accessFirst = -1;
+        accessLast = -1;
+        windowFirst = -1;
+        windowLast = -1;
+        changedPages.clear();
+        
+        if (loadingPage != -1) {
+            loadingPage = -1;
+            pageRequest->cancel();
+        }
+        
+        nextHref.clear();
+        cancelPrefetch();
+        
+        if (fetchingAll) {
+            Q_Q(ResourcesModel);
+            cancelFetchAll();
+            emit q->statusChanged(q->status());
+        }
+    }
+    
+    void _q_updateWindow() {
+        windowUpdateScheduled = false;
+        
+        if (accessFirst == -1) {
+            return;
+        }
+        
+        bool changed = true;
+        
+        for (int i = accessFirst; i <= accessLast; i++) {
+            if (!changedPages.contains(i)) {
+                changed = false;
+                break;
+            }
+        }
+        
+        if ((changed) && (windowFirst != -1)) {
+            // Views read the pages that were evicted or fetched again, so they are added to the visible pages,
+            // rather than replacing them, which would evict the other visible pages.
+            windowFirst = qMin(windowFirst, accessFirst);
+            windowLast = qMax(windowLast, accessLast);
+        }
+        else {
+            windowFirst = accessFirst;
+            windowLast = accessLast;
+            
+            // Pages that could not be fetched are tried again when the view moves.
+            for (int i = 0; i < pages.size(); i++) {
+                pages[i].failed = false;
+            }
+        }
+        
+        accessFirst = -1;
+        accessLast = -1;
+        changedPages.clear();
+        updateWindow();
+    }
+    
+    void updateWindow() {
+        if ((residentPages <= 0) || (windowFirst == -1)) {
+            return;
+        }
+        
+        // The visible pages are never evicted, even if there are more of them than residentPages.
+        for (int i = 0; i < pages.size(); i++) {
+            if ((!inWindow(i)) && (pages.at(i).resident)) {
+                evictPage(i);
+            }
+        }
+        
+        fetchEvictedPage();
+    }
+    
+    void evictPage(int i) {
+        ResourcesPage &page = pages[i];
+        page.resident = false;
+        
+        if (page.count <= 0) {
+            return;
+        }
+        
+        Q_Q(ResourcesModel);
+        
+        const int idColumn = column("id");
+        const int last = page.first + page.count - 1;
+        
+        for (int c = 0; c < columnData.size(); c++) {
+            if (c != idColumn) {
+                for (int row = page.first; row <= last; row++) {
+                    columnData[c].setValue(row, QVariant());
+                }
+            }
+        }
+        
+        changedPages.insert(i);
+        emit q->dataChanged(q->index(page.first), q->index(last));
+    }
+    
+    void fetchEvictedPage() {
+        if ((loadingPage != -1) || (residentPages <= 0) || (windowFirst == -1)) {
+            return;
+        }
+        
+        const int last = qMin(pages.size() - 1, windowEnd());
+        
+        for (int i = windowStart(); i <= last; i++) {
+            if ((!pages.at(i).resident) && (!pages.at(i).failed)) {
+                fetchPage(i);
+                return;
+            }
+        }
+    }
+    
+    void fetchPage(int i) {
+        if (!pageRequest) {
+            pageRequest = createRequest(SLOT(_q_onPageRequestFinished()));
+        }
+        
+        copyCredentials(pageRequest);
+        loadingPage = i;
+        
+        const ResourcesPage &page = pages.at(i);
+        
+        if (page.href.isEmpty()) {
+            pageRequest->get(resourcePath, page.filters);
+        }
+        else {
+            pageRequest->getNext(page.href);
+        }
+    }
+    
+    void _q_onPageRequestFinished() {
+        if ((!pageRequest) || (loadingPage == -1)) {
+            return;
+        }
+        
+        Q_Q(ResourcesModel);
+        
+        const int i = loadingPage;
+        loadingPage = -1;
+        
+        if (i >= pages.size()) {
+            return;
+        }
+        
+        if (pageRequest->status() != ResourcesRequest::Ready) {
+            // The page keeps only its ids, and the other evicted pages are still fetched.
+            pages[i].failed = true;
+            fetchEvictedPage();
+            return;
+        }
+        
+        if (inWindow(i)) {
+            QHash<QString, QVariantMap> fetched;
+            
+            foreach (QVariant item, resultItems(pageRequest->result().toMap())) {
+                const QVariantMap map = item.toMap();
+                fetched[map.value("id").toString()] = map;
+            }
+            
+            ResourcesPage &page = pages[i];
+            const int idColumn = column("id");
+            const int last = page.first + page.count - 1;
+            
+            for (int row = page.first; row <= last; row++) {
+                QMapIterator<QString, QVariant> iterator(fetched.value(value(row, idColumn).toString()));
+                
+                while (iterator.hasNext()) {
+                    iterator.next();
+                    setValue(row, iterator.key(), iterator.value());
+                }
+            }
+            
+            page.resident = true;
+            emitRoleNamesChanged();
+            
+            if (page.count > 0) {
+                changedPages.insert(i);
+                emit q->dataChanged(q->index(page.first), q->index(last));
+            }
+        }
+        
+        fetchEvictedPage();
+    }
+        
+    void _q_prefetch() {
+        prefetchScheduled = false;
+        
+        if ((!hasMore) || (prefetchDistance <= 0) || (prefetching) || (prefetched) || (fetchingAll)
+            || (request->status() == ResourcesRequest::Loading)) {
+            return;
+        }
+        
+        const QVariantMap next = nextPageFilters();
+        
+        if ((nextHref.isEmpty() ? next == prefetchFilters : nextHref == prefetchHref)) {
+            // The prefetch of this page has already failed, so leave it to fetchMore().
+            return;
+        }
+        
+        if (!prefetchRequest) {
+            prefetchRequest = createRequest(SLOT(_q_onPrefetchRequestFinished()));
+            prefetchRequest->setPriority(Request::PrefetchPriority);
+        }
+        
+        copyCredentials(prefetchRequest);
+        prefetching = true;
+        
+        if (nextHref.isEmpty()) {
+            prefetchFilters = next;
+            prefetchRequest->get(resourcePath, prefetchFilters);
+        }
+        else {
+            prefetchHref = nextHref;
+            prefetchRequest->getNext(prefetchHref);
+        }
+    }
+    
+    void cancelPrefetch() {
+        prefetchResult.clear();
+        prefetchFilters.clear();
+        prefetchHref.clear();
+        prefetched = false;
+        fetchMoreOnPrefetch = false;
+        
+        if (prefetching) {
+            prefetching = false;
+            prefetchRequest->cancel();
+        }
+    }
+    
+    void _q_onPrefetchRequestFinished() {
+        if ((!prefetchRequest) || (!prefetching)) {
+            return;
+        }
+        
+        Q_Q(ResourcesModel);
+        
+        prefetching = false;
+        
+        if (prefetchRequest->status() == ResourcesRequest::Ready) {
+            prefetchResult = prefetchRequest->result().toMap();
+            prefetched = true;
+        }
+        
+        if (fetchMoreOnPrefetch) {
+            fetchMoreOnPrefetch = false;
+            q->fetchMore();
+        }
+    }
+    
+    bool isCursorQuery() const {
+        return filters.value("linked_partitioning").toInt() > 0;
+    }
+    
+    void startFetchAll(int maxConcurrency) {
+        fetchingAll = true;
+        fetchAllConcurrency = (isCursorQuery() ? 1 : maxConcurrency);
+        fetchAllNext = 0;
+        fetchAllFlushed = 0;
+        fetchAllEnd = -1;
+        fetchAllNextHref.clear();
+        fetchAllResults.clear();
+        fetchMoreAll();
+    }
+    
+    void fetchMoreAll() {
+        while ((fetchAllRequests.size() < fetchAllConcurrency)
+               && ((fetchAllEnd == -1) || (fetchAllNext < fetchAllEnd))) {
+            ResourcesFetch fetch(fetchAllNext);
+            
+            if (isCursorQuery()) {
+                if (fetchAllNext > 0) {
+                    if (fetchAllNextHref.isEmpty()) {
+                        return;
+                    }
+                    
+                    fetch.href = fetchAllNextHref;
+                    fetchAllNextHref.clear();
+                }
+                
+                // The filters of the query are kept with every page, so that the query is still paged by cursor.
+                fetch.filters = filters;
+            }
+            else {
+                const int page = qMax(1, filters.value("page").toInt());
+                fetch.filters = filters;
+                
+                if ((fetchAllNext > 0) || (filters.contains("page"))) {
+                    fetch.filters["page"] = page + fetchAllNext;
+                }
+            }
+            
+            ResourcesRequest *r = (fetchAllPool.isEmpty() ? createRequest(SLOT(_q_onFetchAllRequestFinished()))
+                                                          : fetchAllPool.takeLast());
+            r->setPriority(Request::BackgroundPriority);
+            copyCredentials(r);
+            fetchAllRequests[r] = fetch;
+            fetchAllNext++;
+            
+            if (fetch.href.isEmpty()) {
+                r->get(resourcePath, fetch.filters);
+            }
+            else {
+                r->getNext(fetch.href);
+            }
+        }
+    }
+    
+    void cancelFetchAll() {
+        fetchingAll = false;
+        fetchAllResults.clear();
+        
+        QHashIterator<ResourcesRequest*, ResourcesFetch> iterator(fetchAllRequests);
+        fetchAllRequests.clear();
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            iterator.key()->cancel();
+            fetchAllPool << iterator.key();
+        }
+    }
+    
+    void _q_onFetchAllRequestFinished() {
+        Q_Q(ResourcesModel);
+        
+        ResourcesRequest *r = qobject_cast<ResourcesRequest*>(q->sender());
+        
+        if ((!r) || (!fetchAllRequests.contains(r))) {
+            return;
+        }
+        
+        ResourcesFetch fetch = fetchAllRequests.take(r);
+        fetchAllPool << r;
+        
+        if (r->status() != ResourcesRequest::Ready) {
+            setLastStatus(r);
+            cancelFetchAll();
+            emit q->statusChanged(q->status());
+            return;
+        }
+        
+        fetch.result = r->result().toMap();
+        bool last;
+        
+        if (fetch.result.contains("collection")) {
+            fetchAllNextHref = fetch.result.value("next_href").toString();
+            last = fetchAllNextHref.isEmpty();
+        }
+        else {
+            last = (!fetch.result.value("has_more").toBool()) || (resultItems(fetch.result).isEmpty());
+        }
+        
+        if ((last) && ((fetchAllEnd == -1) || (fetch.index < fetchAllEnd))) {
+            fetchAllEnd = fetch.index + 1;
+            
+            // Pages after the last one are not needed.
+            QMutableHashIterator<ResourcesRequest*, ResourcesFetch> iterator(fetchAllRequests);
+            
+            while (iterator.hasNext()) {
+                iterator.next();
+                
+                if (iterator.value().index >= fetchAllEnd) {
+                    ResourcesRequest *unused = iterator.key();
+                    iterator.remove();
+                    unused->cancel();
+                    fetchAllPool << unused;
+                }
+            }
+        }
+        
+        fetchAllResults[fetch.index] = fetch;
+        fetchMoreAll();
+        
+        while ((fetchAllResults.contains(fetchAllFlushed))
+               && ((fetchAllEnd == -1) || (fetchAllFlushed < fetchAllEnd))) {
+            const ResourcesFetch page = fetchAllResults.take(fetchAllFlushed++);
+            filters = page.filters;
+            href = page.href;
+            appendPage(page.result);
+        }
+        
+        if ((fetchAllEnd != -1) && (fetchAllFlushed >= fetchAllEnd)) {
+            setLastStatus(r);
+            cancelFetchAll();
+            emit q->statusChanged(q->status());
+        }
+    }
+    
+    void appendPage(const QVariantMap &result) {
+        if (result.isEmpty()) {
+            return;
+        }
+        
+        Q_Q(ResourcesModel);
+        
+        if (result.contains("collection")) {
+            nextHref = result.value("next_href").toString();
+            hasMore = !nextHref.isEmpty();
+        }
+        else {
+            hasMore = result.value("has_more").toBool();
+        }
+        
+        QVariantList list = resultItems(result);
+        
+        if (!list.isEmpty()) {
+            QList<QVariantMap> maps;
+            
+            foreach (QVariant item, list) {
+                maps << item.toMap();
+            }
+            
+            flushPendingItems();
+            const int first = count;
+            q->appendRows(maps);
+            pages << ResourcesPage(first, maps.size(), filters, href);
+        }
+    }
+    
     void _q_onListRequestFinished() {
         if (!request) {
             return;
         }
+        
+        Q_Q(ResourcesModel);
+        
+        if (request->status() == ResourcesRequest::Ready) {
+            appendPage(request->result().toMap());
+        }
+        
+        ResourcesModel::disconnect(request, SIGNAL(finished()), q, SLOT(_q_onListRequestFinished()));
+    
+        emit q->statusChanged(request->status());
+    }
+    
+    int rowOf(const QString &id) const {
+        const int idColumn = column("id");
+        
+        if ((idColumn == -1) || (id.isEmpty())) {
+            return -1;
+        }
+        
+        for (int i = 0; i < count; i++) {
+            if (value(i, idColumn).toString() == id) {
+                return i;
+            }
+        }
+        
+        return -1;
+    }
+    
+    static QString resourceUrl(const QString &resourcePath, const QString &id) {
+        return QString("%1%2%3").arg(resourcePath).arg(resourcePath.endsWith("/") ? QString() : QString("/")).arg(id);
+    }
+    
+    bool hasWrite(const QString &url) const {
+        foreach (const ResourcesWrite &write, activeWrites) {
+            if (write.url == url) {
+                return true;
+            }
+        }
+        
+        foreach (const ResourcesWrite &write, pendingWrites) {
+            if (write.url == url) {
+                return true;
+            }
+        }
+        
+        return false;
+    }
     
-        Q_Q(ResourcesModel);
+    void queueWrite(const ResourcesWrite &write) {
+        pendingWrites << write;
+        dispatchWrites();
+    }
     
-        if (request->status() == ResourcesRequest::Ready) {
-            QVariantMap result = request->result().toMap();
+    void dispatchWrites() {
+        QSet<QString> busy;
         
-            if (!result.isEmpty()) {
-                hasMore = result.value("has_more").toBool();
+        foreach (const ResourcesWrite &write, activeWrites) {
+            busy << write.url;
+        }
+        
+        int i = 0;
+        
+        while ((i < pendingWrites.size()) && (activeWrites.size() < MAX_CONCURRENT_WRITES)) {
+            const QString url = pendingWrites.at(i).url;
+            
+            // Writes to the same resource are sent in the order in which they were made.
+            if (busy.contains(url)) {
+                i++;
+                continue;
+            }
             
-                QVariantList list = result.value("list").toList();
+            busy << url;
             
-                if (!list.isEmpty()) {
-                    if (items.isEmpty()) {
-                        setRoleNames(list.first().toMap());
-                    }
-                    
-                    q->beginInsertRows(QModelIndex(), items.size(), items.size() + list.size() - 1);
-                    
-                    foreach (QVariant item, list) {
-                        items << item.toMap();
-                    }
-                    
-                    q->endInsertRows();
-                    emit q->countChanged(q->rowCount());
-                }
+            const ResourcesWrite write = pendingWrites.takeAt(i);
+            ResourcesRequest *r = (writePool.isEmpty() ? createRequest(SLOT(_q_onWriteRequestFinished()))
+                                                       : writePool.takeLast());
+            copyCredentials(r);
+            activeWrites[r] = write;
+            
+            switch (write.operation) {
+            case ResourcesWrite::Insert:
+                r->insert(write.resource, write.url);
+                break;
+            case ResourcesWrite::InsertItem:
+                r->insert(write.url);
+                break;
+            case ResourcesWrite::Update:
+                r->update(write.url, write.resource);
+                break;
+            default:
+                r->del(write.url);
+                break;
             }
         }
-        
-        ResourcesModel::disconnect(request, SIGNAL(finished()), q, SLOT(_q_onListRequestFinished()));
-    
-        emit q->statusChanged(request->status());
     }
     
-    void _q_onInsertRequestFinished() {
-        if (!request) {
+    void rollbackWrite(const ResourcesWrite &write) {
+        if ((!write.applied) || (write.listPath != resourcePath)) {
             return;
         }
-    
+        
         Q_Q(ResourcesModel);
-    
-        if ((request->status() == ResourcesRequest::Ready) && (writeResourcePath == resourcePath)) {
-            QVariantMap result = request->result().toMap();
         
-            if (!result.isEmpty()) {
-                if (items.isEmpty()) {
-                    setRoleNames(result);
-                }
-                q->beginInsertRows(QModelIndex(), 0, 0);
-                items.prepend(result);
-                q->endInsertRows();
-                emit q->countChanged(q->rowCount());
+        switch (write.operation) {
+        case ResourcesWrite::InsertItem:
+        {
+            const int row = rowOf(write.id);
+            
+            if (row != -1) {
+                q->removeRows(row, 1);
             }
+            
+            break;
+        }
+        case ResourcesWrite::Update:
+        {
+            const int row = rowOf(write.id);
+            
+            if (row != -1) {
+                q->set(row, write.previous);
+            }
+            
+            break;
+        }
+        case ResourcesWrite::Delete:
+            if (rowOf(write.id) == -1) {
+                q->Model::insert(qBound(0, write.row, count), write.previous);
+            }
+            
+            break;
+        default:
+            break;
         }
-        
-        ResourcesModel::disconnect(request, SIGNAL(finished()), q, SLOT(_q_onInsertRequestFinished()));
-    
-        emit q->statusChanged(request->status());
     }
     
-    void _q_onUpdateRequestFinished() {
-        if (!request) {
+    void _q_removeDeletedRows() {
+        Q_Q(ResourcesModel);
+        
+        deletedRowsScheduled = false;
+        
+        const int idColumn = column("id");
+        
+        if ((idColumn == -1) || (deletedIds.isEmpty())) {
+            deletedIds.clear();
             return;
         }
-    
-        Q_Q(ResourcesModel);
-    
-        if (request->status() == ResourcesRequest::Ready) {
-            QVariantMap result = request->result().toMap();
         
-            if (!result.isEmpty()) {
-                QVariant id = result.value("id");
+        // Remove contiguous ranges from the end, so that the rows before each range are not moved.
+        int row = count - 1;
+        
+        while (row >= 0) {
+            if (deletedIds.contains(value(row, idColumn).toString())) {
+                const int last = row;
                 
-                if (!id.isNull()) {
-                    for (int i = 0; i < items.size(); i++) {
-                        if (items.at(i).value("id") == id) {
-                            q->set(i, result);
-                            break;
-                        }
-                    }
+                while ((row > 0) && (deletedIds.contains(value(row - 1, idColumn).toString()))) {
+                    row--;
                 }
+                
+                q->removeRows(row, last - row + 1);
             }
+            
+            row--;
         }
         
-        ResourcesModel::disconnect(request, SIGNAL(finished()), q, SLOT(_q_onUpdateRequestFinished()));
-    
-        emit q->statusChanged(request->status());
+        deletedIds.clear();
     }
     
-    void _q_onDeleteRequestFinished() {
-        if (!request) {
+    void _q_onWriteRequestFinished() {
+        Q_Q(ResourcesModel);
+        
+        ResourcesRequest *r = qobject_cast<ResourcesRequest*>(q->sender());
+        
+        if ((!r) || (!activeWrites.contains(r))) {
             return;
         }
-    
-        Q_Q(ResourcesModel);
-    
-        if ((request->status() == ResourcesRequest::Ready) &&
-            ((writeResourcePath == resourcePath) || (writeResourcePath.isEmpty()))) {
-            for (int i = 0; i < items.size(); i++) {
-                if (items.at(i).value("id") == delId) {
-                    q->beginRemoveRows(QModelIndex(), i, i);
-                    items.removeAt(i);
-                    q->endRemoveRows();
-                    emit q->countChanged(q->rowCount());
-                    break;
+        
+        const ResourcesWrite write = activeWrites.take(r);
+        writePool << r;
+        
+        if (r->status() == ResourcesRequest::Ready) {
+            const QVariantMap result = r->result().toMap();
+            
+            if ((write.operation == ResourcesWrite::Delete) && (!write.applied) && (write.listPath == resourcePath)) {
+                deletedIds << write.id;
+                
+                if (!deletedRowsScheduled) {
+                    deletedRowsScheduled = true;
+                    QMetaObject::invokeMethod(q, "_q_removeDeletedRows", Qt::QueuedConnection);
+                }
+            }
+            else if ((!result.isEmpty()) && (write.listPath == resourcePath)) {
+                if (write.operation == ResourcesWrite::Insert) {
+                    q->Model::insert(0, result);
+                }
+                // The result is not applied if a later write to the same resource has already been applied.
+                else if (((write.operation == ResourcesWrite::Update)
+                          || (write.operation == ResourcesWrite::InsertItem)) && (!hasWrite(write.url))) {
+                    const int row = rowOf(write.id);
+                    
+                    if (row != -1) {
+                        q->set(row, result);
+                    }
                 }
             }
         }
+        else {
+            rollbackWrite(write);
+            emit q->writeFailed(write.url, r->error(), r->errorString());
+        }
         
-        ResourcesModel::disconnect(request, SIGNAL(finished()), q, SLOT(_q_onDeleteRequestFinished()));
-    
-        emit q->statusChanged(request->status());
+        if ((!fetchingAll) && (request->status() != ResourcesRequest::Loading)) {
+            setLastStatus(r);
+        }
+        
+        dispatchWrites();
+        emit q->pendingWritesChanged();
+        emit q->statusChanged(q->status());
     }
     
     ResourcesRequest *request;
+    bool statusFromRequest;
+    ResourcesRequest::Status lastStatus;
+    QVariant lastResult;
+    ResourcesRequest::Error lastError;
+    QString lastErrorString;
+    ResourcesRequest *pageRequest;
+    ResourcesRequest *prefetchRequest;
+    
+    QNetworkAccessManager *manager;
     
     QString resourcePath;
     QVariantMap filters;
-    QString writeResourcePath;
-    QString delId;
+    QString href;
+    QString firstHref;
+    QString nextHref;
+    QList<ResourcesWrite> pendingWrites;
+    QHash<ResourcesRequest*, ResourcesWrite> activeWrites;
+    QList<ResourcesRequest*> writePool;
+    QSet<QString> deletedIds;
+    bool deletedRowsScheduled;
         
     bool hasMore;
     
+    QList<ResourcesPage> pages;
+    int residentPages;
+    int accessFirst;
+    int accessLast;
+    int windowFirst;
+    int windowLast;
+    QSet<int> changedPages;
+    int loadingPage;
+    bool windowUpdateScheduled;
+    
+    int prefetchDistance;
+    QVariantMap prefetchFilters;
+    QString prefetchHref;
+    QVariantMap prefetchResult;
+    bool prefetching;
+    bool prefetched;
+    bool fetchMoreOnPrefetch;
+    bool prefetchScheduled;
+    
+    QHash<ResourcesRequest*, ResourcesFetch> fetchAllRequests;
+    QList<ResourcesRequest*> fetchAllPool;
+    QMap<int, ResourcesFetch> fetchAllResults;
+    QString fetchAllNextHref;
+    bool fetchingAll;
+    int fetchAllConcurrency;
+    int fetchAllNext;
+    int fetchAllFlushed;
+    int fetchAllEnd;
+    
     Q_DECLARE_PUBLIC(ResourcesModel)
 };
 
@@ -172,11 +994,43 @@ public:
     provides the same methods that are available in ResourcesRequest, so it is better to simply use that class if you 
     do not need the additional features provided by a data model.
     
+    Paging
+    
+    By default, every item retrieved by get() and fetchMore() is kept in memory. When residentPages is set, only 
+    that number of pages around the pages most recently read by a view keep their data. The pages read by a view 
+    are never evicted, even if there are more of them than residentPages. The items in other pages are reduced to 
+    their id, so that rowCount() does not change, and the page is requested again when a view reads one of its 
+    items. The page is requested with the same filters or cursor with which it was first retrieved, so a cache set 
+    on the QNetworkAccessManager will be used if it holds the page.
+    
+    When prefetchDistance is set, the next page is requested as soon as a view reads an item within that number of 
+    rows of the end of the model, provided that no other request is in progress. The retrieved items are held back 
+    until fetchMore() is called, and are then inserted without waiting for the network. If fetchMore() is called 
+    while the prefetch is still in progress, the items are inserted as soon as it finishes. A pending prefetch is 
+    cancelled by get(), reload(), clear() and cancel().
+    
+    Writes
+    
+    insert(), update() and del() can be called at any time, including while a list is being retrieved. Each write 
+    is queued and sent as soon as possible. Writes to different resources are sent at the same time, while writes to 
+    the same resource are sent in the order in which they were made. Where possible, the change is applied to the 
+    model immediately, without waiting for the response. If a write fails, its change is undone, and the 
+    writeFailed() signal is emitted.
+    
+    If the \c linked_partitioning filter is set to 1, the SoundCloud Data API returns each page with a cursor to 
+    the next one, and fetchMore() follows the cursor instead of requesting the next page number. This avoids 
+    skipped or repeated items when the collection changes while it is being read, and is faster for pages far 
+    from the start. The cursor of each page is kept, so pages that are no longer resident are requested from 
+    their own cursor. The cursor of the next page is available as the cursor property, and can be stored and 
+    passed to resume() to continue from the same point later.
+    
     Roles
     
     The roles and role names of ResourcesModel are created dynamically when the model is populated with data. The roles 
     are created by iterating through the keys of the first item in alphabetical order, starting at Qt::UserRole + 1.
-    The role names are the keys themselves.
+    A new role is added whenever a later item contains a key that has not been seen before, and the 
+    roleNamesChanged() signal is emitted. The role names are the keys themselves, and the role of a key does not 
+    change for the lifetime of the model, even when it is cleared and repopulated.
     
     Example usage:
     
@@ -233,6 +1087,7 @@ ResourcesModel::ResourcesModel(QObject *parent) :
     Q_D(ResourcesModel);
 
     d->request = new ResourcesRequest(this);
+    d->statusFromRequest = true;
     connect(d->request, SIGNAL(clientIdChanged()), this, SIGNAL(clientIdChanged()));
     connect(d->request, SIGNAL(clientSecretChanged()), this, SIGNAL(clientSecretChanged()));
     connect(d->request, SIGNAL(accessTokenChanged(QString)), this, SIGNAL(accessTokenChanged(QString)));
@@ -353,7 +1208,11 @@ void ResourcesModel::setRefreshToken(const QString &token) {
 ResourcesRequest::Status ResourcesModel::status() const {
     Q_D(const ResourcesModel);
     
-    return d->request->status();
+    if (d->fetchingAll) {
+        return ResourcesRequest::Loading;
+    }
+    
+    return d->statusFromRequest ? d->request->status() : d->lastStatus;
 }
 
 /*!
@@ -365,7 +1224,7 @@ ResourcesRequest::Status ResourcesModel::status() const {
 QVariant ResourcesModel::result() const {
     Q_D(const ResourcesModel);
     
-    return d->request->result();
+    return d->statusFromRequest ? d->request->result() : d->lastResult;
 }
 
 /*!
@@ -377,7 +1236,7 @@ QVariant ResourcesModel::result() const {
 ResourcesRequest::Error ResourcesModel::error() const {
     Q_D(const ResourcesModel);
     
-    return d->request->error();
+    return d->statusFromRequest ? d->request->error() : d->lastError;
 }
 
 /*!
@@ -389,7 +1248,7 @@ ResourcesRequest::Error ResourcesModel::error() const {
 QString ResourcesModel::errorString() const {
     Q_D(const ResourcesModel);
     
-    return d->request->errorString();
+    return d->statusFromRequest ? d->request->errorString() : d->lastErrorString;
 }
 
 /*!
@@ -404,7 +1263,102 @@ QString ResourcesModel::errorString() const {
 void ResourcesModel::setNetworkAccessManager(QNetworkAccessManager *manager) {
     Q_D(ResourcesModel);
     
+    d->manager = manager;
     d->request->setNetworkAccessManager(manager);
+    
+    if (d->pageRequest) {
+        d->pageRequest->setNetworkAccessManager(manager);
+    }
+    
+    if (d->prefetchRequest) {
+        d->prefetchRequest->setNetworkAccessManager(manager);
+    }
+    
+    foreach (ResourcesRequest *request, d->fetchAllPool + d->fetchAllRequests.keys() + d->writePool
+                                        + d->activeWrites.keys()) {
+        request->setNetworkAccessManager(manager);
+    }
+}
+
+/*!
+    \property int ResourcesModel::residentPages
+    \brief The maximum number of retrieved pages that keep their data in memory.
+    
+    The pages kept are those nearest to the page of the item most recently read by a view. The other pages keep 
+    only the id of each item, and are retrieved again when needed. The default value is 0, meaning that all pages 
+    are kept.
+*/
+
+/*!
+    \fn void ResourcesModel::residentPagesChanged()
+    \brief Emitted when residentPages changes.
+*/
+int ResourcesModel::residentPages() const {
+    Q_D(const ResourcesModel);
+    
+    return d->residentPages;
+}
+
+void ResourcesModel::setResidentPages(int pages) {
+    Q_D(ResourcesModel);
+    
+    pages = qMax(0, pages);
+    
+    if (pages != d->residentPages) {
+        d->residentPages = pages;
+        d->updateWindow();
+        emit residentPagesChanged();
+    }
+}
+
+/*!
+    \property int ResourcesModel::prefetchDistance
+    \brief The number of rows from the end of the model at which the next page is prefetched.
+    
+    The default value is 0, meaning that the next page is not requested until fetchMore() is called. The next page 
+    is requested with Request::PrefetchPriority.
+*/
+
+/*!
+    \fn void ResourcesModel::prefetchDistanceChanged()
+    \brief Emitted when prefetchDistance changes.
+*/
+int ResourcesModel::prefetchDistance() const {
+    Q_D(const ResourcesModel);
+    
+    return d->prefetchDistance;
+}
+
+void ResourcesModel::setPrefetchDistance(int distance) {
+    Q_D(ResourcesModel);
+    
+    distance = qMax(0, distance);
+    
+    if (distance != d->prefetchDistance) {
+        d->prefetchDistance = distance;
+        emit prefetchDistanceChanged();
+    }
+}
+
+/*!
+    \property QString ResourcesModel::cursor
+    \brief The cursor of the next page to be retrieved.
+    
+    The cursor is set only when the \c linked_partitioning filter is used, and is empty when there are no more 
+    pages. It does not contain any credentials.
+    
+    \sa resume()
+*/
+QString ResourcesModel::cursor() const {
+    Q_D(const ResourcesModel);
+    
+    if (d->nextHref.isEmpty()) {
+        return QString();
+    }
+    
+    QUrl u(d->nextHref);
+    removeUrlCredentials(&u);
+    return QString::fromUtf8(u.toEncoded());
 }
 
 bool ResourcesModel::canFetchMore(const QModelIndex &) const {
@@ -414,18 +1368,53 @@ bool ResourcesModel::canFetchMore(const QModelIndex &) const {
     
     Q_D(const ResourcesModel);
     
-    return d->hasMore;
+    return (d->hasMore) && (!d->fetchMoreOnPrefetch);
 }
 
 void ResourcesModel::fetchMore(const QModelIndex &) {
     if (canFetchMore()) {
         Q_D(ResourcesModel);
         
-        int page = d->filters.value("page").toInt();
-        d->filters["page"] = (page > 0 ? page + 1 : 2);
+        if (d->prefetchDistance > 0) {
+            MetricsPrivate::recordCache(MetricsPrivate::PrefetchCache, (d->prefetched) || (d->prefetching));
+        }
+        
+        if (d->prefetched) {
+            if (d->prefetchHref.isEmpty()) {
+                d->filters = d->prefetchFilters;
+            }
+            else {
+                d->href = d->prefetchHref;
+            }
+            
+            d->prefetchFilters.clear();
+            d->prefetchHref.clear();
+            d->prefetched = false;
+            d->appendPage(d->prefetchResult);
+            d->prefetchResult.clear();
+            emit statusChanged(status());
+            return;
+        }
+        
+        if (d->prefetching) {
+            d->fetchMoreOnPrefetch = true;
+            emit statusChanged(status());
+            return;
+        }
+        
+        d->statusFromRequest = true;
         connect(d->request, SIGNAL(finished()), this, SLOT(_q_onListRequestFinished()));
-        d->request->get(d->resourcePath, d->filters);
-        emit statusChanged(d->request->status());
+        
+        if (d->nextHref.isEmpty()) {
+            d->filters = d->nextPageFilters();
+            d->request->get(d->resourcePath, d->filters);
+        }
+        else {
+            d->href = d->nextHref;
+            d->request->getNext(d->href);
+        }
+        
+        emit statusChanged(status());
     }
 }
 
@@ -440,92 +1429,237 @@ void ResourcesModel::get(const QString &resourcePath, const QVariantMap &filters
         clear();
         d->resourcePath = resourcePath;
         d->filters = filters;
+        d->href.clear();
+        d->firstHref.clear();
         
+        d->statusFromRequest = true;
         connect(d->request, SIGNAL(finished()), this, SLOT(_q_onListRequestFinished()));
         d->request->get(d->resourcePath, d->filters);
-        emit statusChanged(d->request->status());
+        emit statusChanged(status());
     }
 }
 
 /*!
-    \brief Inserts a new SoundCloud resource into the current resourcePath.
+    \brief Clears any existing data and retrieves every page of the SoundCloud resources belonging to 
+    \a resourcePath.
     
-    \sa ResourcesRequest::insert()
+    Up to \a maxConcurrency pages are requested at the same time, starting from the page in \a filters. The 
+    items of each page are appended as soon as it and every page before it have been retrieved, so the items are 
+    always in the same order as when using fetchMore(). The status is Loading until the last page has been 
+    appended, or until a request fails, in which case the items already appended are kept, and fetchMore() 
+    continues from the last page appended.
+    
+    If the \c linked_partitioning filter is set, the cursor of each page is known only when the page before it has 
+    been retrieved, so the pages are requested one at a time. Each request is sent as soon as the cursor is 
+    received, before the items of the previous page are appended.
+    
+    The pages are requested with Request::BackgroundPriority, so any limit set using RequestScheduler also applies to 
+    the number of pages requested at the same time, and they give way to interactive requests.
+    
+    \sa get(), fetchMore()
 */
-void ResourcesModel::insert(const QVariantMap &resource) {
+void ResourcesModel::fetchAll(const QString &resourcePath, const QVariantMap &filters, int maxConcurrency) {
     if (status() != ResourcesRequest::Loading) {
         Q_D(ResourcesModel);
-        connect(d->request, SIGNAL(finished()), this, SLOT(_q_onInsertRequestFinished()));
-        d->request->insert(resource, d->resourcePath);
-        emit statusChanged(d->request->status());
+        clear();
+        d->resourcePath = resourcePath;
+        d->filters = filters;
+        d->href.clear();
+        d->firstHref.clear();
+        d->startFetchAll(qMax(1, maxConcurrency));
+        emit statusChanged(status());
     }
 }
 
+/*!
+    \brief Inserts a new SoundCloud resource into the current resourcePath.
+    
+    The resource is added to the model when the request has succeeded, since its id is assigned by the server.
+    
+    \sa ResourcesRequest::insert(), writeFailed()
+*/
+void ResourcesModel::insert(const QVariantMap &resource) {
+    Q_D(ResourcesModel);
+    
+    ResourcesWrite write(ResourcesWrite::Insert, d->resourcePath, d->resourcePath);
+    write.resource = resource;
+    d->queueWrite(write);
+    emit pendingWritesChanged();
+}
+
 /*!
     \brief Inserts the SoundCloud resource at \a row into \a resourcePath.
     
-    \sa ResourcesRequest::insert()
+    If \a resourcePath is the current resourcePath, the resource is added to the start of the model immediately, 
+    and removed again if the request fails.
+    
+    \sa ResourcesRequest::insert(), writeFailed()
 */
 void ResourcesModel::insert(int row, const QString &resourcePath) {
-    if (status() != ResourcesRequest::Loading) {
-        Q_D(ResourcesModel);
-        d->writeResourcePath = resourcePath;
-        connect(d->request, SIGNAL(finished()), this, SLOT(_q_onInsertRequestFinished()));
-        d->request->insert(QString("%1%2%3").arg(resourcePath)
-                                            .arg(resourcePath.endsWith("/") ? QString() : QString("/"))
-                                            .arg(Model::get(row).value("id").toString()));
-        emit statusChanged(d->request->status());
+    Q_D(ResourcesModel);
+    
+    if ((row < 0) || (row >= rowCount())) {
+#ifdef QSOUNDCLOUD_DEBUG
+        qDebug() << "QSoundCloud::ResourcesModel::insert(): Row out of range" << row;
+#endif
+        return;
     }
+    
+    const QVariantMap resource = Model::get(row);
+    ResourcesWrite write(ResourcesWrite::InsertItem, d->resourceUrl(resourcePath, resource.value("id").toString()),
+                         resourcePath);
+    write.id = resource.value("id").toString();
+    
+    if (resourcePath == d->resourcePath) {
+        Model::insert(0, resource);
+        write.applied = true;
+    }
+    
+    d->queueWrite(write);
+    emit pendingWritesChanged();
 }
 
 /*!
     \brief Updates the SoundCloud resource at \a row with \a resource.
+    
+    The model is updated immediately, and the previous values are restored if the request fails.
+    
+    \sa writeFailed()
 */
 void ResourcesModel::update(int row, const QVariantMap &resource) {
-    if (status() != ResourcesRequest::Loading) {
-        Q_D(ResourcesModel);
-        d->writeResourcePath = d->resourcePath;
-        connect(d->request, SIGNAL(finished()), this, SLOT(_q_onUpdateRequestFinished()));
-        d->request->update(QString("%1%2%3").arg(d->resourcePath)
-                                            .arg(d->resourcePath.endsWith("/") ? QString() : QString("/"))
-                                            .arg(Model::get(row).value("id").toString()), resource);
-        emit statusChanged(d->request->status());
+    Q_D(ResourcesModel);
+    
+    if ((row < 0) || (row >= rowCount())) {
+#ifdef QSOUNDCLOUD_DEBUG
+        qDebug() << "QSoundCloud::ResourcesModel::update(): Row out of range" << row;
+#endif
+        return;
     }
+    
+    const QVariantMap current = Model::get(row);
+    ResourcesWrite write(ResourcesWrite::Update, d->resourceUrl(d->resourcePath, current.value("id").toString()),
+                         d->resourcePath);
+    write.id = current.value("id").toString();
+    write.resource = resource;
+    
+    QMapIterator<QString, QVariant> iterator(resource);
+    
+    while (iterator.hasNext()) {
+        iterator.next();
+        write.previous[iterator.key()] = current.value(iterator.key());
+    }
+    
+    set(row, resource);
+    write.applied = true;
+    d->queueWrite(write);
+    emit pendingWritesChanged();
 }
 
 /*!
     \brief Deletes the SoundCloud resource at \a row from the current resourcePath.
+    
+    The resource is removed from the model immediately, and restored if the request fails.
+    
+    \sa writeFailed()
 */
 void ResourcesModel::del(int row) {
-    if (status() != ResourcesRequest::Loading) {
-        Q_D(ResourcesModel);
-        d->delId = Model::get(row).value("id").toString();
-        d->writeResourcePath = d->resourcePath;
-        connect(d->request, SIGNAL(finished()), this, SLOT(_q_onDeleteRequestFinished()));
-        d->request->del(QString("%1%2%3").arg(d->resourcePath).arg(d->resourcePath.endsWith("/") ? QString() : QString("/"))
-                                         .arg(d->delId));
-        emit statusChanged(d->request->status());
-    }
+    Q_D(ResourcesModel);
+    
+    del(row, d->resourcePath);
 }
 
 /*!
     \brief Deletes the SoundCloud resource at \a row from \a resourcePath.
+    
+    If \a resourcePath is the current resourcePath, the resource is removed from the model immediately, and 
+    restored if the request fails.
+    
+    \sa writeFailed()
 */
 void ResourcesModel::del(int row, const QString &resourcePath) {
-    if (status() != ResourcesRequest::Loading) {
-        Q_D(ResourcesModel);
-        d->delId = Model::get(row).value("id").toString();
-        d->writeResourcePath = resourcePath;
-        connect(d->request, SIGNAL(finished()), this, SLOT(_q_onDeleteRequestFinished()));
-        d->request->del(QString("%1%2%3").arg(resourcePath).arg(resourcePath.endsWith("/") ? QString() : QString("/"))
-                                         .arg(d->delId));
-        emit statusChanged(d->request->status());
+    Q_D(ResourcesModel);
+    
+    if ((row < 0) || (row >= rowCount())) {
+#ifdef QSOUNDCLOUD_DEBUG
+        qDebug() << "QSoundCloud::ResourcesModel::del(): Row out of range" << row;
+#endif
+        return;
+    }
+    
+    const QVariantMap resource = Model::get(row);
+    ResourcesWrite write(ResourcesWrite::Delete, d->resourceUrl(resourcePath, resource.value("id").toString()),
+                         resourcePath);
+    write.id = resource.value("id").toString();
+    
+    if (resourcePath == d->resourcePath) {
+        write.previous = resource;
+        write.row = row;
+        removeRows(row, 1);
+        write.applied = true;
+    }
+    
+    d->queueWrite(write);
+    emit pendingWritesChanged();
+}
+
+/*!
+    \brief Deletes the SoundCloud resources at \a rows from the current resourcePath.
+    
+    The deletes are sent at the same time, up to the limit on concurrent writes. Unlike del(), the rows are not 
+    removed immediately. Instead, the rows whose deletes have been confirmed are removed together, with one 
+    notification for each contiguous range of rows. Rows whose deletes fail are kept, and writeFailed() is emitted 
+    for each of them.
+*/
+void ResourcesModel::delRows(const QList<int> &rows) {
+    Q_D(ResourcesModel);
+    
+    QSet<QString> ids;
+    
+    foreach (int row, rows) {
+        const QString id = d->value(row, "id").toString();
+        
+        if ((!id.isEmpty()) && (!ids.contains(id))) {
+            ids << id;
+            ResourcesWrite write(ResourcesWrite::Delete, d->resourceUrl(d->resourcePath, id), d->resourcePath);
+            write.id = id;
+            d->pendingWrites << write;
+        }
+    }
+    
+    if (!ids.isEmpty()) {
+        d->dispatchWrites();
+        emit pendingWritesChanged();
     }
 }
 
+/*!
+    \property int ResourcesModel::pendingWrites
+    \brief The number of writes made by insert(), update() and del() that have not yet finished.
+*/
+
+/*!
+    \fn void ResourcesModel::pendingWritesChanged()
+    \brief Emitted when pendingWrites changes.
+*/
+int ResourcesModel::pendingWrites() const {
+    Q_D(const ResourcesModel);
+    
+    return d->pendingWrites.size() + d->activeWrites.size();
+}
+
+/*!
+    \fn void ResourcesModel::writeFailed(const QString &resourcePath, QSoundCloud::ResourcesRequest::Error error, 
+                                          const QString &errorString)
+    \brief Emitted when a write to \a resourcePath fails.
+    
+    Any change made to the model by the write has been undone when this signal is emitted.
+*/
+
 /*!
     \brief Cancels the current request.
     
+    Any prefetch, or retrieval started by fetchAll(), in progress is also cancelled.
+    
     \sa ResourcesRequest::cancel()
 */
 void ResourcesModel::cancel() {
@@ -534,6 +1668,13 @@ void ResourcesModel::cancel() {
     if (d->request) {
         d->request->cancel();
     }
+    
+    d->cancelPrefetch();
+    
+    if (d->fetchingAll) {
+        d->cancelFetchAll();
+        emit statusChanged(status());
+    }
 }
 
 /*!
@@ -543,14 +1684,49 @@ void ResourcesModel::reload() {
     if (status() != ResourcesRequest::Loading) {
         Q_D(ResourcesModel);
         clear();
+        d->href = d->firstHref;
         
         if (!d->filters.value("page").isNull()) {
             d->filters["page"] = 1;
         }
         
+        d->statusFromRequest = true;
         connect(d->request, SIGNAL(finished()), this, SLOT(_q_onListRequestFinished()));
-        d->request->get(d->resourcePath, d->filters);
-        emit statusChanged(d->request->status());
+        
+        if (d->href.isEmpty()) {
+            d->request->get(d->resourcePath, d->filters);
+        }
+        else {
+            d->request->getNext(d->href);
+        }
+        
+        emit statusChanged(status());
+    }
+}
+
+/*!
+    \brief Clears any existing data and retrieves the SoundCloud resources belonging to \a resourcePath, starting 
+    from \a cursor.
+    
+    \a cursor is a value previously read from the cursor property. The filters of the query, such as 
+    \c linked_partitioning, are read from \a cursor, so the remaining pages are retrieved in the same way.
+    
+    \sa ResourcesRequest::getNext()
+*/
+void ResourcesModel::resume(const QString &resourcePath, const QString &cursor) {
+    if (status() != ResourcesRequest::Loading) {
+        Q_D(ResourcesModel);
+        clear();
+        d->resourcePath = resourcePath;
+        // The filters of the query are kept, so that a cursor query is still paged using the cursor.
+        d->filters = urlFilters(QUrl::fromEncoded(cursor.toUtf8()));
+        d->href = cursor;
+        d->firstHref = cursor;
+        
+        d->statusFromRequest = true;
+        connect(d->request, SIGNAL(finished()), this, SLOT(_q_onListRequestFinished()));
+        d->request->getNext(d->href);
+        emit statusChanged(status());
     }
 }
 
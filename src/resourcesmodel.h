@@ -37,6 +37,10 @@ class QSOUNDCLOUDSHARED_EXPORT ResourcesModel : public Model
     Q_PROPERTY(QVariant result READ result NOTIFY statusChanged)
     Q_PROPERTY(QSoundCloud::ResourcesRequest::Error error READ error NOTIFY statusChanged)
     Q_PROPERTY(QString errorString READ errorString NOTIFY statusChanged)
+    Q_PROPERTY(int residentPages READ residentPages WRITE setResidentPages NOTIFY residentPagesChanged)
+    Q_PROPERTY(QString cursor READ cursor NOTIFY statusChanged)
+    Q_PROPERTY(int pendingWrites READ pendingWrites NOTIFY pendingWritesChanged)
+    Q_PROPERTY(int prefetchDistance READ prefetchDistance WRITE setPrefetchDistance NOTIFY prefetchDistanceChanged)
                 
 public: 
     explicit ResourcesModel(QObject *parent = 0);
@@ -62,12 +66,24 @@ public:
     
     void setNetworkAccessManager(QNetworkAccessManager *manager);
     
+    int residentPages() const;
+    void setResidentPages(int pages);
+    
+    int prefetchDistance() const;
+    void setPrefetchDistance(int distance);
+    
+    QString cursor() const;
+    
+    int pendingWrites() const;
+    
     bool canFetchMore(const QModelIndex &parent = QModelIndex()) const;
     Q_INVOKABLE void fetchMore(const QModelIndex &parent = QModelIndex());
     
 public Q_SLOTS:
     void get(const QString &resourcePath, const QVariantMap &filters = QVariantMap());
     
+    void fetchAll(const QString &resourcePath, const QVariantMap &filters = QVariantMap(), int maxConcurrency = 4);
+    
     void insert(const QVariantMap &resource);
     
     void insert(int row, const QString &resourcePath);
@@ -78,24 +94,36 @@ public Q_SLOTS:
     
     void del(int row, const QString &resourcePath);
     
+    void delRows(const QList<int> &rows);
+    
     void cancel();
     void reload();
     
+    void resume(const QString &resourcePath, const QString &cursor);
+
 Q_SIGNALS:
     void clientIdChanged();
     void clientSecretChanged();
     void accessTokenChanged(const QString &token);
     void refreshTokenChanged(const QString &token);
     void statusChanged(QSoundCloud::ResourcesRequest::Status s);
+    void residentPagesChanged();
+    void prefetchDistanceChanged();
+    void pendingWritesChanged();
+    void writeFailed(const QString &resourcePath, QSoundCloud::ResourcesRequest::Error error, const QString &errorString);
     
 private:        
     Q_DECLARE_PRIVATE(ResourcesModel)
     Q_DISABLE_COPY(ResourcesModel)
     
     Q_PRIVATE_SLOT(d_func(), void _q_onListRequestFinished())
-    Q_PRIVATE_SLOT(d_func(), void _q_onInsertRequestFinished())
-    Q_PRIVATE_SLOT(d_func(), void _q_onUpdateRequestFinished())
-    Q_PRIVATE_SLOT(d_func(), void _q_onDeleteRequestFinished())
+    Q_PRIVATE_SLOT(d_func(), void _q_onWriteRequestFinished())
+    Q_PRIVATE_SLOT(d_func(), void _q_removeDeletedRows())
+    Q_PRIVATE_SLOT(d_func(), void _q_onPageRequestFinished())
+    Q_PRIVATE_SLOT(d_func(), void _q_updateWindow())
+    Q_PRIVATE_SLOT(d_func(), void _q_prefetch())
+    Q_PRIVATE_SLOT(d_func(), void _q_onPrefetchRequestFinished())
+    Q_PRIVATE_SLOT(d_func(), void _q_onFetchAllRequestFinished())
 };
 
 }
@@ -20,6 +20,153 @@
 
 namespace QSoundCloud {
 
+class ResourcesRequestPrivate : public RequestPrivate
+{
+
+public:
+    ResourcesRequestPrivate(ResourcesRequest *parent) :
+        RequestPrivate(parent),
+        delNext(0),
+        delCanceled(false),
+        delTimedOut(false)
+    {
+    }
+    
+    void cancel() {
+        RequestPrivate::cancel();
+        
+        if (delRequests.isEmpty()) {
+            return;
+        }
+        
+        // Resources that have not been requested are reported as not deleted.
+        delCanceled = true;
+        
+        while (delNext < delPaths.size()) {
+            failed << delPaths.at(delNext++);
+        }
+        
+        foreach (ResourcesRequest *request, delRequests.keys()) {
+            request->cancel();
+        }
+    }
+    
+    void _q_onDeadline() {
+        if ((status != Request::Loading) || (delRequests.isEmpty())) {
+            RequestPrivate::_q_onDeadline();
+            return;
+        }
+        
+        // The deletes in progress are canceled, and the request fails once they have finished.
+        delTimedOut = true;
+        
+        while (delNext < delPaths.size()) {
+            failed << delPaths.at(delNext++);
+        }
+        
+        foreach (ResourcesRequest *request, delRequests.keys()) {
+            request->cancel();
+        }
+    }
+    
+    void delNextResource() {
+        Q_Q(ResourcesRequest);
+        
+        ResourcesRequest *request = (delPool.isEmpty() ? 0 : delPool.takeLast());
+        
+        if (!request) {
+            request = new ResourcesRequest(q);
+            ResourcesRequest::connect(request, SIGNAL(finished()), q, SLOT(_q_onDelRequestFinished()));
+        }
+        
+        request->setNetworkAccessManager(networkAccessManager());
+        request->setClientId(clientId);
+        request->setClientSecret(clientSecret);
+        request->setAccessToken(accessToken);
+        request->setRefreshToken(refreshToken);
+        request->setHeaders(headers);
+        // Each delete is traced as part of this operation.
+        request->d_func()->parentSpanId = operationSpan.id();
+        request->d_func()->parentTraceId = operationSpan.traceId();
+        delRequests[request] = delPaths.at(delNext);
+        request->del(delPaths.at(delNext++));
+    }
+    
+    void _q_onDelRequestFinished() {
+        Q_Q(ResourcesRequest);
+        
+        ResourcesRequest *request = qobject_cast<ResourcesRequest*>(q->sender());
+        
+        if ((!request) || (!delRequests.contains(request))) {
+            return;
+        }
+        
+        const QString path = delRequests.take(request);
+        delPool << request;
+        
+        if (request->status() == Request::Ready) {
+            deleted << path;
+        }
+        else {
+            if (failed.isEmpty()) {
+                setError(request->error());
+                setErrorString(request->errorString());
+            }
+            
+            failed << path;
+        }
+        
+        // Keep any access token refreshed by the request.
+        if (request->accessToken() != accessToken) {
+            q->setAccessToken(request->accessToken());
+            q->setRefreshToken(request->refreshToken());
+        }
+        
+        if (delNext < delPaths.size()) {
+            delNextResource();
+            return;
+        }
+        
+        if (!delRequests.isEmpty()) {
+            return;
+        }
+        
+        QVariantMap res;
+        res["deleted"] = deleted;
+        res["failed"] = failed;
+        setResult(res);
+        
+        if (delTimedOut) {
+            setStatus(Request::Failed);
+            setError(Request::TimeoutError);
+            setErrorString(Request::tr("The request deadline was exceeded"));
+        }
+        else if (failed.isEmpty()) {
+            setStatus(Request::Ready);
+            setError(Request::NoError);
+            setErrorString(QString());
+        }
+        else {
+            setStatus(delCanceled ? Request::Canceled : Request::Failed);
+        }
+        
+        finish();
+    }
+    
+    QStringList delPaths;
+    int delNext;
+    bool delCanceled;
+    bool delTimedOut;
+    
+    QHash<ResourcesRequest*, QString> delRequests;
+    QList<ResourcesRequest*> delPool;
+    
+    QVariantList deleted;
+    QVariantList failed;
+    
+    Q_DECLARE_PUBLIC(ResourcesRequest)
+};
+
 /*!
     \class ResourcesRequest
     \brief Handles requests for SoundCloud resources.
@@ -87,7 +234,7 @@ namespace QSoundCloud {
     <a target="_blank" href="https://developers.soundcloud.com/docs/api/reference">here</a>.
 */
 ResourcesRequest::ResourcesRequest(QObject *parent) :
-    Request(parent)
+    Request(*new ResourcesRequestPrivate(this), parent)
 {
 }
 
@@ -127,6 +274,46 @@ void ResourcesRequest::get(const QString &resourcePath, const QVariantMap &filte
     Request::get();
 }
 
+/*!
+    \brief Requests the next page of a collection from \a nextHref.
+    
+    When a collection is requested with the \c linked_partitioning filter set to 1, the result contains the items 
+    in \c collection, and the URL of the next page in \c next_href. Passing that URL to this method follows the 
+    cursor directly, rather than requesting an offset.
+    
+    Any credentials in \a nextHref are replaced with those of the request, so a cursor can be stored and used after 
+    the access token has been refreshed.
+    
+    \code
+    ResourcesRequest request;
+    QVariantMap filters;
+    filters["limit"] = 50;
+    filters["linked_partitioning"] = 1;
+    request.get("/me/activities", filters);
+    
+    ...
+    
+    request.getNext(request.result().toMap().value("next_href").toString());
+    \endcode
+*/
+void ResourcesRequest::getNext(const QString &nextHref) {
+    if (status() == Loading) {
+        return;
+    }
+    
+    QUrl u(nextHref);
+    
+    if (u.isRelative()) {
+        u = QUrl(QString("%1%2%3").arg(API_URL).arg(nextHref.startsWith("/") ? QString() : QString("/"))
+                                  .arg(nextHref));
+    }
+    
+    removeUrlCredentials(&u);
+    setUrl(u);
+    setData(QVariant());
+    Request::get();
+}
+
 /*!
     \brief Inserts a SoundCloud resource into \a resourcePath using a PUT request.
     
@@ -215,4 +402,58 @@ void ResourcesRequest::del(const QString &resourcePath) {
     deleteResource();
 }
 
+/*!
+    \brief Deletes the SoundCloud resources at \a resourcePaths.
+    
+    Up to \a maxConcurrency resources are deleted at the same time, using the same QNetworkAccessManager as this 
+    request. The request finishes when every delete has finished. The result is a map containing the paths that 
+    were deleted in \c deleted, and those that were not in \c failed. If any delete fails, the error and 
+    errorString are those of the first delete that failed.
+    
+    For example, to 'unfavorite' several tracks on behalf of the authenticated user:
+    
+    \code
+    ResourcesRequest request;
+    request.delMany(QStringList() << "/me/favorites/TRACK_ID_1" << "/me/favorites/TRACK_ID_2");
+    \endcode
+*/
+void ResourcesRequest::delMany(const QStringList &resourcePaths, int maxConcurrency) {
+    if (status() == Loading) {
+        return;
+    }
+    
+    Q_D(ResourcesRequest);
+    
+    d->delPaths = resourcePaths;
+    d->delNext = 0;
+    d->delCanceled = false;
+    d->delTimedOut = false;
+    d->deleted.clear();
+    d->failed.clear();
+    // The operation is started like any other, so it has a deadline, timings and a trace span.
+    d->startOperation();
+    d->setOperation(DeleteOperation);
+    d->setError(NoError);
+    d->setErrorString(QString());
+    d->beginTrace(QUrl(API_URL));
+    
+    if (resourcePaths.isEmpty()) {
+        QVariantMap res;
+        res["deleted"] = QVariantList();
+        res["failed"] = QVariantList();
+        d->setResult(res);
+        d->setStatus(Ready);
+        d->finish();
+        return;
+    }
+    
+    d->setStatus(Loading);
+    
+    for (int i = qMax(1, maxConcurrency); (i > 0) && (d->delNext < resourcePaths.size()); i--) {
+        d->delNextResource();
+    }
 }
+
+}
+
+#include "moc_resourcesrequest.cpp"
@@ -21,6 +21,8 @@
 
 namespace QSoundCloud {
 
+class ResourcesRequestPrivate;
+
 class QSOUNDCLOUDSHARED_EXPORT ResourcesRequest : public Request
 {
     Q_OBJECT
@@ -31,6 +33,8 @@ public:
 public Q_SLOTS:    
     void get(const QString &resourcePath, const QVariantMap &filters = QVariantMap());
     
+    void getNext(const QString &nextHref);
+    
     void insert(const QString &resourcePath);
     
     void insert(const QVariantMap &resource, const QString &resourcePath);
@@ -39,8 +43,13 @@ public Q_SLOTS:
     
     void del(const QString &resourcePath);
     
+    void delMany(const QStringList &resourcePaths, int maxConcurrency = 4);
+
 private:
+    Q_DECLARE_PRIVATE(ResourcesRequest)
     Q_DISABLE_COPY(ResourcesRequest)
+    
+    Q_PRIVATE_SLOT(d_func(), void _q_onDelRequestFinished())
 };
 
 }
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "result.h"
+
+namespace QSoundCloud {
+
+/*!
+    \class Result
+    \brief The outcome of a request made using Client.
+    
+    \ingroup requests
+    
+    Result holds the status, result and error of a finished request, as reported by the request itself.
+    
+    \sa Client
+*/
+Result::Result() :
+    m_status(Request::Null),
+    m_error(Request::NoError)
+{
+}
+
+Result::Result(Request::Status status, const QVariant &result, Request::Error error, const QString &errorString,
+               const RequestTimings &timings) :
+    m_status(status),
+    m_result(result),
+    m_error(error),
+    m_errorString(errorString),
+    m_timings(timings)
+{
+}
+
+/*!
+    \brief Returns the status of the request.
+    
+    \sa Request::status
+*/
+Request::Status Result::status() const {
+    return m_status;
+}
+
+/*!
+    \brief Returns the result of the request.
+    
+    \sa Request::result
+*/
+QVariant Result::result() const {
+    return m_result;
+}
+
+/*!
+    \brief Returns the error type of the request.
+    
+    \sa Request::error
+*/
+Request::Error Result::error() const {
+    return m_error;
+}
+
+/*!
+    \brief Returns a description of the error of the request.
+    
+    \sa Request::errorString
+*/
+QString Result::errorString() const {
+    return m_errorString;
+}
+
+/*!
+    \brief Returns true if the request finished successfully.
+*/
+bool Result::isReady() const {
+    return m_status == Request::Ready;
+}
+
+/*!
+    \brief Returns the timings of the request.
+    
+    The result of a continuation has the timings of the last request made, while a Result combining the results 
+    of several requests has empty timings.
+    
+    \sa Request::timings()
+*/
+RequestTimings Result::timings() const {
+    return m_timings;
+}
+
+}
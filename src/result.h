@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QSOUNDCLOUD_RESULT_H
+#define QSOUNDCLOUD_RESULT_H
+
+#include "request.h"
+#include <QMetaType>
+
+namespace QSoundCloud {
+
+class QSOUNDCLOUDSHARED_EXPORT Result
+{
+
+public:
+    Result();
+    Result(Request::Status status, const QVariant &result = QVariant(), Request::Error error = Request::NoError,
+           const QString &errorString = QString(), const RequestTimings &timings = RequestTimings());
+    
+    Request::Status status() const;
+    
+    QVariant result() const;
+    
+    Request::Error error() const;
+    QString errorString() const;
+    
+    bool isReady() const;
+    
+    RequestTimings timings() const;
+
+private:
+    Request::Status m_status;
+    
+    QVariant m_result;
+    
+    Request::Error m_error;
+    
+    QString m_errorString;
+    
+    RequestTimings m_timings;
+};
+
+}
+
+Q_DECLARE_METATYPE(QSoundCloud::Result)
+
+#endif // QSOUNDCLOUD_RESULT_H
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "retrypolicy.h"
+#include <QMutex>
+#include <qmath.h>
+
+namespace QSoundCloud {
+
+class DefaultRetryPolicy
+{
+
+public:
+    QMutex mutex;
+    
+    RetryPolicy policy;
+};
+
+Q_GLOBAL_STATIC(DefaultRetryPolicy, defaultRetryPolicy)
+
+/*!
+    \class RetryPolicy
+    \brief Determines how requests are retried after a transient error.
+    
+    \ingroup requests
+    
+    A request that fails because of a transient error is made again after a delay, up to maximumRetries times.
+    Transient errors are a connection closed by the server, a temporary network failure, a timeout, an HTTP 5xx
+    response and an HTTP 429 (Too Many Requests) response.
+    
+    The delay before the first retry is initialDelay, and the delay is multiplied by multiplier for each following
+    retry, up to maximumDelay. A random part of each delay, given by jitter, is left out, so that requests that
+    failed at the same time are not all retried at the same time. If the response has a Retry-After header, the
+    delay is at least the time given. A request is not retried if the server asks for a delay longer than
+    maximumDelay.
+    
+    Only HEAD, GET, PUT and DELETE requests are retried, since making a POST request more than once may not be
+    safe, unless retryNonIdempotent is enabled.
+    
+    The default policy allows 3 retries, starting at 500 milliseconds and doubling up to 30 seconds, with full
+    jitter. The policy used by new requests can be changed using setDefaultPolicy().
+    
+    \sa Request::setRetryPolicy()
+*/
+RetryPolicy::RetryPolicy() :
+    m_maximumRetries(3),
+    m_initialDelay(500),
+    m_maximumDelay(30000),
+    m_multiplier(2.0),
+    m_jitter(1.0),
+    m_retryNonIdempotent(false)
+{
+}
+
+RetryPolicy::RetryPolicy(int maximumRetries, int initialDelay, int maximumDelay) :
+    m_maximumRetries(maximumRetries),
+    m_initialDelay(initialDelay),
+    m_maximumDelay(maximumDelay),
+    m_multiplier(2.0),
+    m_jitter(1.0),
+    m_retryNonIdempotent(false)
+{
+}
+
+/*!
+    \brief Returns the maximum number of times that a request is retried.
+    
+    A value of 0 disables retries.
+*/
+int RetryPolicy::maximumRetries() const {
+    return m_maximumRetries;
+}
+
+/*!
+    \brief Sets the maximum number of times that a request is retried to \a retries.
+*/
+void RetryPolicy::setMaximumRetries(int retries) {
+    m_maximumRetries = qMax(0, retries);
+}
+
+/*!
+    \brief Returns the delay before the first retry, in milliseconds.
+*/
+int RetryPolicy::initialDelay() const {
+    return m_initialDelay;
+}
+
+/*!
+    \brief Sets the delay before the first retry to \a delay milliseconds.
+*/
+void RetryPolicy::setInitialDelay(int delay) {
+    m_initialDelay = qMax(0, delay);
+}
+
+/*!
+    \brief Returns the maximum delay before a retry, in milliseconds.
+*/
+int RetryPolicy::maximumDelay() const {
+    return m_maximumDelay;
+}
+
+/*!
+    \brief Sets the maximum delay before a retry to \a delay milliseconds.
+*/
+void RetryPolicy::setMaximumDelay(int delay) {
+    m_maximumDelay = qMax(0, delay);
+}
+
+/*!
+    \brief Returns the factor by which the delay is multiplied for each retry.
+*/
+qreal RetryPolicy::multiplier() const {
+    return m_multiplier;
+}
+
+/*!
+    \brief Sets the factor by which the delay is multiplied for each retry to \a multiplier.
+*/
+void RetryPolicy::setMultiplier(qreal multiplier) {
+    m_multiplier = qMax(qreal(1.0), multiplier);
+}
+
+/*!
+    \brief Returns the fraction of each delay that is random.
+    
+    A value of 1.0 (the default) means that each delay is chosen at random between zero and the full delay, while
+    a value of 0.0 disables jitter.
+*/
+qreal RetryPolicy::jitter() const {
+    return m_jitter;
+}
+
+/*!
+    \brief Sets the fraction of each delay that is random to \a jitter.
+*/
+void RetryPolicy::setJitter(qreal jitter) {
+    m_jitter = qBound(qreal(0.0), jitter, qreal(1.0));
+}
+
+/*!
+    \brief Returns true if POST requests are retried.
+    
+    The default is false.
+*/
+bool RetryPolicy::retryNonIdempotent() const {
+    return m_retryNonIdempotent;
+}
+
+/*!
+    \brief Sets whether POST requests are retried to \a enabled.
+*/
+void RetryPolicy::setRetryNonIdempotent(bool enabled) {
+    m_retryNonIdempotent = enabled;
+}
+
+/*!
+    \brief Returns the delay in milliseconds before retry number \a retry (starting at 0).
+    
+    \a random must be between 0.0 and 1.0, and determines the random part of the delay.
+*/
+int RetryPolicy::delay(int retry, qreal random) const {
+    const qreal backoff = qMin(qreal(m_maximumDelay), m_initialDelay * qPow(m_multiplier, retry));
+    return qRound(backoff * (1.0 - m_jitter * qBound(qreal(0.0), random, qreal(1.0))));
+}
+
+/*!
+    \brief Returns the policy used by new requests.
+*/
+RetryPolicy RetryPolicy::defaultPolicy() {
+    DefaultRetryPolicy *d = defaultRetryPolicy();
+    QMutexLocker locker(&d->mutex);
+    return d->policy;
+}
+
+/*!
+    \brief Sets the policy used by new requests to \a policy.
+    
+    Requests that have already been created keep their policy.
+*/
+void RetryPolicy::setDefaultPolicy(const RetryPolicy &policy) {
+    DefaultRetryPolicy *d = defaultRetryPolicy();
+    QMutexLocker locker(&d->mutex);
+    d->policy = policy;
+}
+
+}
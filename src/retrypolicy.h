@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QSOUNDCLOUD_RETRYPOLICY_H
+#define QSOUNDCLOUD_RETRYPOLICY_H
+
+#include "qsoundcloud_global.h"
+
+namespace QSoundCloud {
+
+class QSOUNDCLOUDSHARED_EXPORT RetryPolicy
+{
+
+public:
+    RetryPolicy();
+    explicit RetryPolicy(int maximumRetries, int initialDelay = 500, int maximumDelay = 30000);
+    
+    int maximumRetries() const;
+    void setMaximumRetries(int retries);
+    
+    int initialDelay() const;
+    void setInitialDelay(int delay);
+    
+    int maximumDelay() const;
+    void setMaximumDelay(int delay);
+    
+    qreal multiplier() const;
+    void setMultiplier(qreal multiplier);
+    
+    qreal jitter() const;
+    void setJitter(qreal jitter);
+    
+    bool retryNonIdempotent() const;
+    void setRetryNonIdempotent(bool enabled);
+    
+    int delay(int retry, qreal random) const;
+    
+    static RetryPolicy defaultPolicy();
+    static void setDefaultPolicy(const RetryPolicy &policy);
+
+private:
+    int m_maximumRetries;
+    int m_initialDelay;
+    int m_maximumDelay;
+    
+    qreal m_multiplier;
+    qreal m_jitter;
+    
+    bool m_retryNonIdempotent;
+};
+
+}
+
+#endif // QSOUNDCLOUD_RETRYPOLICY_H
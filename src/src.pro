@@ -11,37 +11,81 @@ DESTDIR = ../lib
 
 HEADERS += \
     authenticationrequest.h \
+    client.h \
+    client_p.h \
+    coroutine.h \
     json.h \
+    metrics.h \
+    metrics_p.h \
     model.h \
     model_p.h \
     qsoundcloud_global.h \
+    ratelimiter.h \
+    ratelimiter_p.h \
     request.h \
     request_p.h \
+    requestobserver.h \
+    requestscheduler.h \
+    requestscheduler_p.h \
+    requesttimings.h \
     resourcesmodel.h \
     resourcesrequest.h \
+    result.h \
+    retrypolicy.h \
     streamsmodel.h \
     streamsrequest.h \
+    timeoutpolicy.h \
+    tokenmanager_p.h \
+    tokenstore.h \
+    tracer.h \
+    tracespan.h \
     urls.h
 
 SOURCES += \
     authenticationrequest.cpp \
+    client.cpp \
     json.cpp \
+    metrics.cpp \
     model.cpp \
+    ratelimiter.cpp \
     request.cpp \
+    requestobserver.cpp \
+    requestscheduler.cpp \
+    requesttimings.cpp \
     resourcesmodel.cpp \
     resourcesrequest.cpp \
+    result.cpp \
+    retrypolicy.cpp \
     streamsmodel.cpp \
-    streamsrequest.cpp
+    streamsrequest.cpp \
+    timeoutpolicy.cpp \
+    tokenmanager.cpp \
+    tokenstore.cpp \
+    tracer.cpp \
+    tracespan.cpp
     
 headers.files += \
     authenticationrequest.h \
+    client.h \
+    coroutine.h \
+    metrics.h \
     model.h \
     qsoundcloud_global.h \
+    ratelimiter.h \
     request.h \
+    requestobserver.h \
+    requestscheduler.h \
+    requesttimings.h \
     resourcesmodel.h \
     resourcesrequest.h \
+    result.h \
+    retrypolicy.h \
     streamsmodel.h \
     streamsrequest.h \
+    timeoutpolicy.h \
+    tokenstore.h \
+    tracer.h \
+    tracespan.h \
     urls.h
     
 symbian {
@@ -40,14 +40,13 @@ public:
             QVariantList list = request->result().toList();
         
             if (!list.isEmpty()) {
-                q->beginInsertRows(QModelIndex(), items.size(), items.size() + list.size());
+                QList<QVariantMap> maps;
                 
                 foreach (QVariant item, list) {
-                    items << item.toMap();
+                    maps << item.toMap();
                 }
                 
-                q->endInsertRows();
-                emit q->countChanged(q->rowCount());
+                appendRows(maps);
             }
         }
         
@@ -153,15 +152,14 @@ StreamsModel::StreamsModel(QObject *parent) :
     Model(*new StreamsModelPrivate(this), parent)
 {
     Q_D(StreamsModel);
-    d->roles[IdRole] = "id";
-    d->roles[DescriptionRole] = "description";
-    d->roles[ExtensionRole] = "ext";
-    d->roles[WidthRole] = "width";
-    d->roles[HeightRole] = "height";
-    d->roles[UrlRole] = "url";
-#if QT_VERSION < 0x050000
-    setRoleNames(d->roles);
-#endif
+    QHash<int, QByteArray> roles;
+    roles[IdRole] = "id";
+    roles[DescriptionRole] = "description";
+    roles[ExtensionRole] = "ext";
+    roles[WidthRole] = "width";
+    roles[HeightRole] = "height";
+    roles[UrlRole] = "url";
+    d->setRoleNames(roles);
     d->request = new StreamsRequest(this);
 }
 
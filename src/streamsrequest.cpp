@@ -16,6 +16,7 @@
 
 #include "streamsrequest.h"
 #include "request_p.h"
+#include "requestscheduler_p.h"
 #include "urls.h"
 #include <QNetworkReply>
 #ifdef QSOUNDCLOUD_DEBUG
@@ -64,14 +65,35 @@ public:
         
         q->setUrl(u);
         reply = networkAccessManager()->head(buildRequest());
+        watchReply();
         StreamsRequest::connect(reply, SIGNAL(finished()), q, slot);
     }
     
+    bool finishIfTimedOut() {
+        // A redirect that times out fails the request, rather than leaving out its format.
+        if (!timedOut) {
+            return false;
+        }
+        
+        const QString es = replyErrorString();
+        reply->deleteLater();
+        reply = 0;
+        setStatus(Request::Failed);
+        setError(Request::TimeoutError);
+        setErrorString(es);
+        finish();
+        return true;
+    }
+    
     void _q_onDownloadRedirect() {
         if (!reply) {
             return;
         }
         
+        if (finishIfTimedOut()) {
+            return;
+        }
+        
         if (reply->error() == QNetworkReply::NoError) {
             QUrl redirect = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toString();
             
@@ -94,14 +116,12 @@ public:
             getRedirect(track.value("stream_url").toString(), SLOT(_q_onStreamRedirect()));
         }
         else {
-            Q_Q(StreamsRequest);
-            
             setResult(formats);
             setStatus(Request::Ready);
             setError(Request::NoError);
             setErrorString(QString());
             
-            emit q->finished();
+            finish();
         }
     }
     
@@ -110,7 +130,9 @@ public:
             return;
         }
         
-        Q_Q(StreamsRequest);
+        if (finishIfTimedOut()) {
+            return;
+        }
         
         if (reply->error() == QNetworkReply::NoError) {
             QUrl redirect = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toString();
@@ -133,7 +155,7 @@ public:
         setError(Request::NoError);
         setErrorString(QString());
         
-        emit q->finished();
+        finish();
     }
     
     void _q_onReplyFinished() {
@@ -143,6 +165,15 @@ public:
     
         Q_Q(StreamsRequest);
         
+        RequestSchedulerPrivate::release(q);
+        reportReply();
+        
+        if (retry()) {
+            reply->deleteLater();
+            reply = 0;
+            return;
+        }
+        
         if (redirects < MAX_REDIRECTS) {
             QUrl redirect = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toString();
     
@@ -159,8 +190,8 @@ public:
         }
         
         const QString response = QString::fromUtf8(reply->readAll());
-        const QNetworkReply::NetworkError e = reply->error();
-        const QString es = reply->errorString();
+        const QNetworkReply::NetworkError e = replyError();
+        const QString es = replyErrorString();
         reply->deleteLater();
         reply = 0;
         
@@ -171,14 +202,14 @@ public:
             setStatus(Request::Canceled);
             setError(Request::NoError);
             setErrorString(QString());
-            emit q->finished();
+            finish();
             return;
         case QNetworkReply::AuthenticationRequiredError:
             if (refreshToken.isEmpty()) {
                 setStatus(Request::Failed);
                 setError(Request::Error(e));
                 setErrorString(es);
-                emit q->finished();
+                finish();
             }
             else {
                 refreshAccessToken();
@@ -189,12 +220,14 @@ public:
             setStatus(Request::Failed);
             setError(Request::Error(e));
             setErrorString(es);
-            emit q->finished();
+            finish();
             return;
         }
         
         bool ok = true;
+        startParse();
         track = QtJson::Json::parse(response, ok).toMap();
+        finishParse();
         formats.clear();
         
         if (ok) {
@@ -219,7 +252,7 @@ public:
             setErrorString(Request::tr("Unable to parse response"));
         }
 
-        emit q->finished();
+        finish();
     }
     
     QVariantList formats;
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "timeoutpolicy.h"
+#include <QMutex>
+
+namespace QSoundCloud {
+
+class DefaultTimeoutPolicy
+{
+
+public:
+    QMutex mutex;
+    
+    TimeoutPolicy policy;
+};
+
+Q_GLOBAL_STATIC(DefaultTimeoutPolicy, defaultTimeoutPolicy)
+
+/*!
+    \class TimeoutPolicy
+    \brief Determines how long a request can take before it fails with Request::TimeoutError.
+    
+    \ingroup requests
+    
+    Each HTTP request made by a Request must be connected within connectTimeout, and must receive the response 
+    headers within firstByteTimeout, both measured from when it is sent. A request that exceeds either of these 
+    is aborted, and is retried according to the RetryPolicy of the Request, since the error is transient.
+    
+    The connection is known to be established when the TLS handshake has finished (with Qt 5), when the request 
+    body has been sent, or when the response headers have been received. When a connection is reused, there is no 
+    handshake, so connectTimeout then also limits the time until the response headers are received.
+    
+    The deadline limits the whole operation, including any time spent waiting for a retry, a rate limit or a 
+    refreshed access token, following redirects, and the further requests made by StreamsRequest. A request that 
+    exceeds its deadline fails without being retried.
+    
+    A value of 0 disables a timeout. The default policy disables all three, so requests wait for as long as the 
+    network allows unless a timeout is set. The policy used by new requests can be changed using setDefaultPolicy().
+    
+    Example usage:
+    
+    \code
+    QSoundCloud::TimeoutPolicy::setDefaultPolicy(QSoundCloud::TimeoutPolicy(30000, 30000));
+    \endcode
+    
+    \sa Request::setTimeoutPolicy()
+*/
+TimeoutPolicy::TimeoutPolicy() :
+    m_connectTimeout(0),
+    m_firstByteTimeout(0),
+    m_deadline(0)
+{
+}
+
+TimeoutPolicy::TimeoutPolicy(int connectTimeout, int firstByteTimeout, int deadline) :
+    m_connectTimeout(connectTimeout),
+    m_firstByteTimeout(firstByteTimeout),
+    m_deadline(deadline)
+{
+}
+
+/*!
+    \brief Returns the time in milliseconds within which an HTTP request must be connected.
+*/
+int TimeoutPolicy::connectTimeout() const {
+    return m_connectTimeout;
+}
+
+/*!
+    \brief Sets the time within which an HTTP request must be connected to \a timeout milliseconds.
+*/
+void TimeoutPolicy::setConnectTimeout(int timeout) {
+    m_connectTimeout = qMax(0, timeout);
+}
+
+/*!
+    \brief Returns the time in milliseconds within which the response headers must be received.
+*/
+int TimeoutPolicy::firstByteTimeout() const {
+    return m_firstByteTimeout;
+}
+
+/*!
+    \brief Sets the time within which the response headers must be received to \a timeout milliseconds.
+*/
+void TimeoutPolicy::setFirstByteTimeout(int timeout) {
+    m_firstByteTimeout = qMax(0, timeout);
+}
+
+/*!
+    \brief Returns the time in milliseconds within which the whole operation must finish.
+*/
+int TimeoutPolicy::deadline() const {
+    return m_deadline;
+}
+
+/*!
+    \brief Sets the time within which the whole operation must finish to \a deadline milliseconds.
+*/
+void TimeoutPolicy::setDeadline(int deadline) {
+    m_deadline = qMax(0, deadline);
+}
+
+/*!
+    \brief Returns the policy used by new requests.
+*/
+TimeoutPolicy TimeoutPolicy::defaultPolicy() {
+    DefaultTimeoutPolicy *d = defaultTimeoutPolicy();
+    QMutexLocker locker(&d->mutex);
+    return d->policy;
+}
+
+/*!
+    \brief Sets the policy used by new requests to \a policy.
+    
+    Requests that have already been created keep their policy.
+*/
+void TimeoutPolicy::setDefaultPolicy(const TimeoutPolicy &policy) {
+    DefaultTimeoutPolicy *d = defaultTimeoutPolicy();
+    QMutexLocker locker(&d->mutex);
+    d->policy = policy;
+}
+
+}
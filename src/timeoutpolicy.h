@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QSOUNDCLOUD_TIMEOUTPOLICY_H
+#define QSOUNDCLOUD_TIMEOUTPOLICY_H
+
+#include "qsoundcloud_global.h"
+
+namespace QSoundCloud {
+
+class QSOUNDCLOUDSHARED_EXPORT TimeoutPolicy
+{
+
+public:
+    TimeoutPolicy();
+    explicit TimeoutPolicy(int connectTimeout, int firstByteTimeout = 0, int deadline = 0);
+    
+    int connectTimeout() const;
+    void setConnectTimeout(int timeout);
+    
+    int firstByteTimeout() const;
+    void setFirstByteTimeout(int timeout);
+    
+    int deadline() const;
+    void setDeadline(int deadline);
+    
+    static TimeoutPolicy defaultPolicy();
+    static void setDefaultPolicy(const TimeoutPolicy &policy);
+
+private:
+    int m_connectTimeout;
+    int m_firstByteTimeout;
+    int m_deadline;
+};
+
+}
+
+#endif // QSOUNDCLOUD_TIMEOUTPOLICY_H
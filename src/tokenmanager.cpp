@@ -0,0 +1,374 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tokenmanager_p.h"
+#include "metrics_p.h"
+#include "tokenstore.h"
+#include "request.h"
+#include "json.h"
+#include "urls.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QThread>
+#include <QTimer>
+#ifdef QSOUNDCLOUD_DEBUG
+#include <QDebug>
+#endif
+
+namespace QSoundCloud {
+
+// Tokens are refreshed REFRESH_MARGIN seconds before they expire, or half way through their lifetime if sooner.
+static const int REFRESH_MARGIN = 60;
+static const int MAX_REFRESH_INTERVAL = 86400000;
+
+Q_GLOBAL_STATIC(TokenManager, tokenManager)
+
+TokenManager::TokenManager() :
+    QObject(),
+    manager(0),
+    timer(0),
+    store(0),
+    saveScheduled(false)
+{
+    // Tokens are refreshed in the main thread, which can be relied upon to run an event loop.
+    if (QCoreApplication *app = QCoreApplication::instance()) {
+        moveToThread(app->thread());
+        // Save any tokens not yet written to the store before the application quits.
+        connect(app, SIGNAL(aboutToQuit()), this, SLOT(_q_saveTokens()));
+    }
+}
+
+TokenManager::~TokenManager() {
+    delete store;
+}
+
+TokenManager* TokenManager::instance() {
+    return tokenManager();
+}
+
+void TokenManager::setStore(TokenStore *s) {
+    QMutexLocker storeLocker(&storeMutex);
+    
+    if (s == store) {
+        return;
+    }
+    
+    delete store;
+    store = s;
+    const QVariantMap loaded = (store ? store->load() : QVariantMap());
+    storeLocker.unlock();
+    
+    QMutexLocker locker(&mutex);
+    tokens = loaded;
+    locker.unlock();
+#ifdef QSOUNDCLOUD_DEBUG
+    qDebug() << "QSoundCloud::TokenManager::setStore" << loaded;
+#endif
+    const QString refreshToken = loaded.value("refreshToken").toString();
+    const qint64 expiresAt = loaded.value("expiresAt").toLongLong();
+    
+    if ((refreshToken.isEmpty()) || (expiresAt <= 0)) {
+        return;
+    }
+    
+    // A stored token that has expired is refreshed straight away, before requests find that it has expired.
+    const qint64 expiresIn = (expiresAt - QDateTime::currentMSecsSinceEpoch()) / 1000;
+    setExpiry(loaded.value("clientId").toString(), loaded.value("clientSecret").toString(),
+              loaded.value("accessToken").toString(), refreshToken, int(qMax(qint64(1), expiresIn)));
+    setUsed(refreshToken);
+}
+
+QVariantMap TokenManager::storedTokens() const {
+    QMutexLocker locker(&mutex);
+    return tokens;
+}
+
+void TokenManager::storeTokens(const QString &clientId, const QString &clientSecret, const QString &accessToken,
+                               const QString &refreshToken) {
+    QMutexLocker storeLocker(&storeMutex);
+    
+    if (!store) {
+        return;
+    }
+    
+    storeLocker.unlock();
+    
+    QMutexLocker locker(&mutex);
+    tokens["clientId"] = clientId;
+    tokens["clientSecret"] = clientSecret;
+    tokens["accessToken"] = accessToken;
+    tokens["refreshToken"] = refreshToken;
+    tokens.remove("expiresAt");
+    scheduleSave();
+}
+
+void TokenManager::scheduleSave() {
+    if (!saveScheduled) {
+        saveScheduled = true;
+        QMetaObject::invokeMethod(this, "_q_saveTokens", Qt::QueuedConnection);
+    }
+}
+
+void TokenManager::_q_saveTokens() {
+    QMutexLocker locker(&mutex);
+    
+    if (!saveScheduled) {
+        return;
+    }
+    
+    const QVariantMap t = tokens;
+    saveScheduled = false;
+    locker.unlock();
+    
+    QMutexLocker storeLocker(&storeMutex);
+    
+    if (store) {
+#ifdef QSOUNDCLOUD_DEBUG
+        qDebug() << "QSoundCloud::TokenManager::_q_saveTokens" << t;
+#endif
+        store->save(t);
+    }
+}
+
+TokenManager::RefreshAction TokenManager::requestRefresh(const QString &failedAccessToken, QString *accessToken,
+                                                         QString *refreshToken) {
+    QMutexLocker locker(&mutex);
+    
+    // Follow the refreshes made since the request was given its tokens, to find the most recent tokens.
+    QStringList tokens;
+    int hops = replacements.size();
+    
+    while ((replacements.contains(*refreshToken)) && (hops-- > 0)) {
+        tokens = replacements.value(*refreshToken);
+        
+        if (tokens.at(1) == *refreshToken) {
+            break;
+        }
+        
+        *refreshToken = tokens.at(1);
+    }
+    
+    if ((!tokens.isEmpty()) && (tokens.at(0) != failedAccessToken)) {
+        *accessToken = tokens.at(0);
+#ifdef QSOUNDCLOUD_DEBUG
+        qDebug() << "QSoundCloud::TokenManager::requestRefresh: Using refreshed tokens" << tokens;
+#endif
+        return UseRefreshedTokens;
+    }
+    
+    if (pending.contains(*refreshToken)) {
+#ifdef QSOUNDCLOUD_DEBUG
+        qDebug() << "QSoundCloud::TokenManager::requestRefresh: Waiting for refresh" << *refreshToken;
+#endif
+        return WaitForRefresh;
+    }
+    
+    pending.insert(*refreshToken);
+#ifdef QSOUNDCLOUD_DEBUG
+    qDebug() << "QSoundCloud::TokenManager::requestRefresh: Starting refresh" << *refreshToken;
+#endif
+    return StartRefresh;
+}
+
+void TokenManager::finishRefresh(const QString &refreshToken, const QString &accessToken,
+                                 const QString &newRefreshToken) {
+    QMutexLocker locker(&mutex);
+    pending.remove(refreshToken);
+    expiries.remove(refreshToken);
+    replacements[refreshToken] = QStringList() << accessToken << newRefreshToken;
+    
+    if (tokens.value("refreshToken") == refreshToken) {
+        tokens["accessToken"] = accessToken;
+        tokens["refreshToken"] = newRefreshToken;
+        tokens.remove("expiresAt");
+        scheduleSave();
+    }
+    
+    locker.unlock();
+#ifdef QSOUNDCLOUD_DEBUG
+    qDebug() << "QSoundCloud::TokenManager::finishRefresh" << refreshToken << accessToken << newRefreshToken;
+#endif
+    MetricsPrivate::recordTokenRefresh(true);
+    emit refreshed(refreshToken, accessToken, newRefreshToken);
+}
+
+void TokenManager::failRefresh(const QString &refreshToken, int error, const QString &errorString) {
+    QMutexLocker locker(&mutex);
+    pending.remove(refreshToken);
+    locker.unlock();
+#ifdef QSOUNDCLOUD_DEBUG
+    qDebug() << "QSoundCloud::TokenManager::failRefresh" << refreshToken << error << errorString;
+#endif
+    // A canceled refresh is not a failure, since the token may still be refreshed by another request.
+    if (error != Request::OperationCanceledError) {
+        MetricsPrivate::recordTokenRefresh(false);
+    }
+    
+    emit refreshFailed(refreshToken, error, errorString);
+}
+
+void TokenManager::setExpiry(const QString &clientId, const QString &clientSecret, const QString &accessToken,
+                             const QString &refreshToken, int expiresIn) {
+    if (refreshToken.isEmpty()) {
+        return;
+    }
+    
+    QMutexLocker locker(&mutex);
+    
+    if (expiresIn <= 0) {
+        expiries.remove(refreshToken);
+        return;
+    }
+    
+    TokenExpiry expiry;
+    expiry.clientId = clientId;
+    expiry.clientSecret = clientSecret;
+    expiry.accessToken = accessToken;
+    expiry.refreshToken = refreshToken;
+    expiry.refreshTime = QDateTime::currentMSecsSinceEpoch()
+                         + qint64(qMax(expiresIn - REFRESH_MARGIN, expiresIn / 2)) * 1000;
+    expiries[refreshToken] = expiry;
+    
+    if (tokens.value("refreshToken") == refreshToken) {
+        tokens["expiresAt"] = QDateTime::currentMSecsSinceEpoch() + qint64(expiresIn) * 1000;
+        scheduleSave();
+    }
+    
+    locker.unlock();
+#ifdef QSOUNDCLOUD_DEBUG
+    qDebug() << "QSoundCloud::TokenManager::setExpiry" << refreshToken << expiresIn;
+#endif
+    QMetaObject::invokeMethod(this, "_q_scheduleRefresh", Qt::QueuedConnection);
+}
+
+void TokenManager::setUsed(const QString &refreshToken) {
+    QMutexLocker locker(&mutex);
+    QHash<QString, TokenExpiry>::iterator iterator = expiries.find(refreshToken);
+    
+    if (iterator != expiries.end()) {
+        iterator.value().used = true;
+    }
+}
+
+void TokenManager::_q_scheduleRefresh() {
+    if (!timer) {
+        timer = new QTimer(this);
+        timer->setSingleShot(true);
+        connect(timer, SIGNAL(timeout()), this, SLOT(_q_refreshExpiringTokens()));
+    }
+    
+    QMutexLocker locker(&mutex);
+    
+    if (expiries.isEmpty()) {
+        timer->stop();
+        return;
+    }
+    
+    qint64 next = 0;
+    
+    foreach (const TokenExpiry &expiry, expiries) {
+        if ((next == 0) || (expiry.refreshTime < next)) {
+            next = expiry.refreshTime;
+        }
+    }
+    
+    locker.unlock();
+    timer->start(int(qBound(qint64(0), next - QDateTime::currentMSecsSinceEpoch(), qint64(MAX_REFRESH_INTERVAL))));
+}
+
+void TokenManager::_q_refreshExpiringTokens() {
+    if (!manager) {
+        manager = new QNetworkAccessManager(this);
+    }
+    
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QList<TokenExpiry> expiring;
+    QMutexLocker locker(&mutex);
+    QMutableHashIterator<QString, TokenExpiry> iterator(expiries);
+    
+    while (iterator.hasNext()) {
+        iterator.next();
+        
+        if (iterator.value().refreshTime > now) {
+            continue;
+        }
+        
+        // Tokens that have not been used since they were issued are left to expire, so that tokens that are no
+        // longer needed are not refreshed indefinitely.
+        if ((iterator.value().used) && (!pending.contains(iterator.key()))) {
+            pending.insert(iterator.key());
+            expiring << iterator.value();
+        }
+        
+        iterator.remove();
+    }
+    
+    locker.unlock();
+    
+    foreach (const TokenExpiry &expiry, expiring) {
+#ifdef QSOUNDCLOUD_DEBUG
+        qDebug() << "QSoundCloud::TokenManager::_q_refreshExpiringTokens" << expiry.refreshToken;
+#endif
+        QUrl tokenUrl(TOKEN_URL);
+        QNetworkRequest request(tokenUrl);
+        request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+        const QString body("client_id=" + expiry.clientId + "&client_secret=" + expiry.clientSecret
+                           + "&refresh_token=" + expiry.refreshToken + "&grant_type=" + GRANT_TYPE_REFRESH);
+        QNetworkReply *reply = manager->post(request, body.toUtf8());
+        connect(reply, SIGNAL(finished()), this, SLOT(_q_onRefreshFinished()));
+        refreshes[reply] = expiry;
+    }
+    
+    _q_scheduleRefresh();
+}
+
+void TokenManager::_q_onRefreshFinished() {
+    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+    
+    if ((!reply) || (!refreshes.contains(reply))) {
+        return;
+    }
+    
+    const TokenExpiry expiry = refreshes.take(reply);
+    bool ok = false;
+    const QVariantMap tokens = QtJson::Json::parse(QString::fromUtf8(reply->readAll()), ok).toMap();
+    const QNetworkReply::NetworkError e = reply->error();
+    reply->deleteLater();
+    
+    const QString token = tokens.value("access_token").toString();
+    
+    if ((e != QNetworkReply::NoError) || (!ok) || (token.isEmpty())) {
+        // Requests waiting for this refresh make their own attempt when their access token is rejected.
+#ifdef QSOUNDCLOUD_DEBUG
+        qDebug() << "QSoundCloud::TokenManager::_q_onRefreshFinished: Unable to refresh" << expiry.refreshToken << e;
+#endif
+        MetricsPrivate::recordTokenRefresh(false);
+        failRefresh(expiry.refreshToken, Request::OperationCanceledError, QString());
+        return;
+    }
+    
+    const QString refresh = tokens.value("refresh_token").toString();
+    finishRefresh(expiry.refreshToken, token, refresh.isEmpty() ? expiry.refreshToken : refresh);
+    setExpiry(expiry.clientId, expiry.clientSecret, token, refresh.isEmpty() ? expiry.refreshToken : refresh,
+              tokens.value("expires_in").toInt());
+}
+
+}
+
+#include "moc_tokenmanager_p.cpp"
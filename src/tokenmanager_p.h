@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QSOUNDCLOUD_TOKENMANAGER_P_H
+#define QSOUNDCLOUD_TOKENMANAGER_P_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QStringList>
+#include <QVariantMap>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+
+namespace QSoundCloud {
+
+class TokenStore;
+
+class TokenExpiry
+{
+
+public:
+    TokenExpiry() :
+        refreshTime(0),
+        used(false)
+    {
+    }
+    
+    QString clientId;
+    QString clientSecret;
+    QString accessToken;
+    QString refreshToken;
+    
+    qint64 refreshTime;
+    
+    bool used;
+};
+
+/*
+    Ensures that only one request refreshes a given refresh token, however many requests (in however many threads)
+    find that their access token has expired. The first request to ask becomes responsible for the refresh, and the
+    others wait for refreshed() or refreshFailed(), which every Request and Client is connected to.
+    
+    Tokens issued with an expiry are also refreshed by the manager itself shortly before they expire, provided that
+    they have been used since they were issued, so that requests do not need to wait for the refresh.
+    
+    The manager owns the TokenStore set by TokenStore::setDefaultStore(). The stored credentials are loaded once and
+    given to each Request and Client when it is created, and new tokens are written back to the store in the main
+    thread.
+*/
+class TokenManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum RefreshAction {
+        StartRefresh = 0,
+        WaitForRefresh,
+        UseRefreshedTokens
+    };
+    
+    TokenManager();
+    ~TokenManager();
+    
+    static TokenManager* instance();
+    
+    void setStore(TokenStore *store);
+    
+    QVariantMap storedTokens() const;
+    void storeTokens(const QString &clientId, const QString &clientSecret, const QString &accessToken,
+                     const QString &refreshToken);
+    
+    RefreshAction requestRefresh(const QString &failedAccessToken, QString *accessToken, QString *refreshToken);
+    
+    void finishRefresh(const QString &refreshToken, const QString &accessToken, const QString &newRefreshToken);
+    void failRefresh(const QString &refreshToken, int error, const QString &errorString);
+    
+    void setExpiry(const QString &clientId, const QString &clientSecret, const QString &accessToken,
+                   const QString &refreshToken, int expiresIn);
+    
+    void setUsed(const QString &refreshToken);
+
+Q_SIGNALS:
+    void refreshed(const QString &previousRefreshToken, const QString &accessToken, const QString &refreshToken);
+    void refreshFailed(const QString &refreshToken, int error, const QString &errorString);
+
+private Q_SLOTS:
+    void _q_scheduleRefresh();
+    void _q_refreshExpiringTokens();
+    void _q_onRefreshFinished();
+    void _q_saveTokens();
+
+private:
+    void scheduleSave();
+    
+    mutable QMutex mutex;
+    
+    QSet<QString> pending;
+    
+    // Maps each refresh token that has been refreshed to the access and refresh tokens obtained with it.
+    QHash<QString, QStringList> replacements;
+    
+    QHash<QString, TokenExpiry> expiries;
+    
+    QHash<QNetworkReply*, TokenExpiry> refreshes;
+    
+    QNetworkAccessManager *manager;
+    
+    QTimer *timer;
+    
+    QMutex storeMutex;
+    
+    TokenStore *store;
+    
+    QVariantMap tokens;
+    
+    bool saveScheduled;
+};
+
+}
+
+#endif // QSOUNDCLOUD_TOKENMANAGER_P_H
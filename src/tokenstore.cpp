@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tokenstore.h"
+#include "tokenmanager_p.h"
+#include "json.h"
+#include <QFile>
+#include <QSettings>
+#include <QStringList>
+#include <QTemporaryFile>
+#ifdef QSOUNDCLOUD_DEBUG
+#include <QDebug>
+#endif
+
+namespace QSoundCloud {
+
+// The keys of the credentials stored by the library.
+static const char* const TOKEN_KEYS[] = { "clientId", "clientSecret", "accessToken", "refreshToken", "expiresAt" };
+static const int TOKEN_KEY_COUNT = sizeof(TOKEN_KEYS) / sizeof(TOKEN_KEYS[0]);
+
+/*!
+    \class TokenStore
+    \brief The base class for storing the credentials used by requests.
+    
+    \ingroup requests
+    
+    A TokenStore loads and saves the credentials used when making requests to the SoundCloud Data API. When a store
+    has been set using setDefaultStore(), its credentials are loaded once, and given to every Request, Client and
+    model when it is created, so that they do not need to be set on each one. Access tokens that are obtained using
+    AuthenticationRequest, or refreshed by any request, are written back to the store in the background.
+    
+    The credentials are a QVariantMap containing the following keys:
+    
+    <table>
+        <tr>
+            <th>Key</th>
+            <th>Description</th>
+        </tr>
+        <tr>
+            <td>clientId</td>
+            <td>The client id.</td>
+        </tr>
+        <tr>
+            <td>clientSecret</td>
+            <td>The client secret.</td>
+        </tr>
+        <tr>
+            <td>accessToken</td>
+            <td>The access token.</td>
+        </tr>
+        <tr>
+            <td>refreshToken</td>
+            <td>The refresh token.</td>
+        </tr>
+        <tr>
+            <td>expiresAt</td>
+            <td>The time at which the access token expires, in milliseconds since the epoch (if known).</td>
+        </tr>
+    </table>
+    
+    If the stored access token has expired, or will soon expire, it is refreshed as soon as the store is set,
+    rather than after it has been rejected.
+    
+    Subclasses must implement load() and save(). save() is called from the main thread.
+    
+    Example usage:
+    
+    \code
+    QSoundCloud::TokenStore::setDefaultStore(new QSoundCloud::SettingsTokenStore);
+    QSoundCloud::ResourcesRequest request;
+    request.get("/me");
+    \endcode
+    
+    \sa MemoryTokenStore, SettingsTokenStore, FileTokenStore
+*/
+TokenStore::~TokenStore() {}
+
+/*!
+    \fn QVariantMap TokenStore::load()
+    \brief Returns the stored credentials.
+*/
+
+/*!
+    \fn void TokenStore::save(const QVariantMap &tokens)
+    \brief Stores \a tokens.
+*/
+
+/*!
+    \brief Sets the store used by all requests to \a store.
+    
+    The library takes ownership of \a store, and deletes any store previously set. Credentials set on a request
+    after it has been created are used by that request, but are not written to the store.
+*/
+void TokenStore::setDefaultStore(TokenStore *store) {
+    TokenManager::instance()->setStore(store);
+}
+
+/*!
+    \class MemoryTokenStore
+    \brief Stores credentials in memory.
+    
+    \ingroup requests
+    
+    MemoryTokenStore is useful for sharing credentials between requests when they should not be persisted.
+*/
+MemoryTokenStore::MemoryTokenStore(const QVariantMap &tokens) :
+    TokenStore(),
+    m_tokens(tokens)
+{
+}
+
+QVariantMap MemoryTokenStore::load() {
+    QMutexLocker locker(&m_mutex);
+    return m_tokens;
+}
+
+void MemoryTokenStore::save(const QVariantMap &tokens) {
+    QMutexLocker locker(&m_mutex);
+    m_tokens = tokens;
+}
+
+/*!
+    \class SettingsTokenStore
+    \brief Stores credentials using QSettings.
+    
+    \ingroup requests
+    
+    The credentials are stored in a group (by default, "Authentication") of the application's default QSettings, so
+    the organization and application names should be set before the store is used. Only the keys of the credentials
+    are read and written, so the group can also hold other settings of the application. The group must not be 
+    empty, and nothing is stored if it is.
+*/
+SettingsTokenStore::SettingsTokenStore(const QString &group) :
+    TokenStore(),
+    m_group(group)
+{
+}
+
+/*!
+    \brief Returns the QSettings group in which the credentials are stored.
+*/
+QString SettingsTokenStore::group() const {
+    return m_group;
+}
+
+QVariantMap SettingsTokenStore::load() {
+    QVariantMap tokens;
+    
+    if (m_group.isEmpty()) {
+        return tokens;
+    }
+    
+    QSettings settings;
+    settings.beginGroup(m_group);
+    
+    for (int i = 0; i < TOKEN_KEY_COUNT; i++) {
+        const QString key = QString::fromLatin1(TOKEN_KEYS[i]);
+        
+        if (settings.contains(key)) {
+            tokens[key] = settings.value(key);
+        }
+    }
+    
+    return tokens;
+}
+
+void SettingsTokenStore::save(const QVariantMap &tokens) {
+    if (m_group.isEmpty()) {
+#ifdef QSOUNDCLOUD_DEBUG
+        qDebug() << "QSoundCloud::SettingsTokenStore::save: No group set";
+#endif
+        return;
+    }
+    
+    QSettings settings;
+    settings.beginGroup(m_group);
+    
+    // Credentials that are not in tokens, such as an expiry time that no longer applies, are removed.
+    for (int i = 0; i < TOKEN_KEY_COUNT; i++) {
+        const QString key = QString::fromLatin1(TOKEN_KEYS[i]);
+        
+        if (tokens.contains(key)) {
+            settings.setValue(key, tokens.value(key));
+        }
+        else {
+            settings.remove(key);
+        }
+    }
+}
+
+/*!
+    \class FileTokenStore
+    \brief Stores credentials in a JSON file.
+    
+    \ingroup requests
+    
+    The file is readable only by its owner, and is replaced only once the new credentials have been written in full.
+*/
+FileTokenStore::FileTokenStore(const QString &fileName) :
+    TokenStore(),
+    m_fileName(fileName)
+{
+}
+
+/*!
+    \brief Returns the name of the file in which the credentials are stored.
+*/
+QString FileTokenStore::fileName() const {
+    return m_fileName;
+}
+
+QVariantMap FileTokenStore::load() {
+    QFile file(m_fileName);
+    
+    if (!file.open(QFile::ReadOnly)) {
+        return QVariantMap();
+    }
+    
+    return QtJson::Json::parse(QString::fromUtf8(file.readAll())).toMap();
+}
+
+void FileTokenStore::save(const QVariantMap &tokens) {
+    // The credentials are written to a temporary file in the same directory, which is created readable only by its
+    // owner, and which then replaces the file. So the credentials are never readable by others, and the file is 
+    // never left partly written.
+    QTemporaryFile file(m_fileName + ".XXXXXX");
+    
+    if (!file.open()) {
+#ifdef QSOUNDCLOUD_DEBUG
+        qDebug() << "QSoundCloud::FileTokenStore::save: Unable to open" << file.fileTemplate();
+#endif
+        return;
+    }
+    
+    file.setPermissions(QFile::ReadOwner | QFile::WriteOwner);
+    
+    if ((file.write(QtJson::Json::serialize(tokens)) == -1) || (!file.flush())) {
+#ifdef QSOUNDCLOUD_DEBUG
+        qDebug() << "QSoundCloud::FileTokenStore::save: Unable to write" << file.fileName();
+#endif
+        return;
+    }
+    
+    file.close();
+    file.setAutoRemove(false);
+    QFile::remove(m_fileName);
+    
+    if (!file.rename(m_fileName)) {
+#ifdef QSOUNDCLOUD_DEBUG
+        qDebug() << "QSoundCloud::FileTokenStore::save: Unable to replace" << m_fileName;
+#endif
+        file.remove();
+    }
+}
+
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QSOUNDCLOUD_TOKENSTORE_H
+#define QSOUNDCLOUD_TOKENSTORE_H
+
+#include "qsoundcloud_global.h"
+#include <QMutex>
+#include <QVariantMap>
+
+namespace QSoundCloud {
+
+class QSOUNDCLOUDSHARED_EXPORT TokenStore
+{
+
+public:
+    virtual ~TokenStore();
+    
+    virtual QVariantMap load() = 0;
+    virtual void save(const QVariantMap &tokens) = 0;
+    
+    static void setDefaultStore(TokenStore *store);
+};
+
+class QSOUNDCLOUDSHARED_EXPORT MemoryTokenStore : public TokenStore
+{
+
+public:
+    explicit MemoryTokenStore(const QVariantMap &tokens = QVariantMap());
+    
+    QVariantMap load();
+    void save(const QVariantMap &tokens);
+
+private:
+    QMutex m_mutex;
+    
+    QVariantMap m_tokens;
+};
+
+class QSOUNDCLOUDSHARED_EXPORT SettingsTokenStore : public TokenStore
+{
+
+public:
+    explicit SettingsTokenStore(const QString &group = QString("Authentication"));
+    
+    QString group() const;
+    
+    QVariantMap load();
+    void save(const QVariantMap &tokens);
+
+private:
+    QString m_group;
+};
+
+class QSOUNDCLOUDSHARED_EXPORT FileTokenStore : public TokenStore
+{
+
+public:
+    explicit FileTokenStore(const QString &fileName);
+    
+    QString fileName() const;
+    
+    QVariantMap load();
+    void save(const QVariantMap &tokens);
+
+private:
+    QString m_fileName;
+};
+
+}
+
+#endif // QSOUNDCLOUD_TOKENSTORE_H
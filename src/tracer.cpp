@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tracer.h"
+#include <QDateTime>
+#include <QList>
+#include <QMutex>
+
+namespace QSoundCloud {
+
+class Tracers
+{
+
+public:
+    Tracers() :
+        nextId(0)
+    {
+    }
+    
+    QMutex mutex;
+    
+    QList<Tracer*> tracers;
+    
+    quint64 nextId;
+};
+
+Q_GLOBAL_STATIC(Tracers, globalTracers)
+
+/*!
+    \class Tracer
+    \brief The base class for tracing the operations performed by the library.
+    
+    \ingroup requests
+    
+    A Tracer that has been added using addTracer() is notified when each span begins and ends. Each Request
+    operation is a span, and each HTTP request made during the operation is a child span, so a multi-step operation
+    such as StreamsRequest::get() can be shown with its critical path in a tracing backend. See TraceSpan for
+    details.
+    
+    beginSpan() and endSpan() are called in the thread of the request, so implementations must be thread-safe if
+    requests are made in more than one thread, such as by Client. The end of an operation span is reported after
+    every slot connected to Request::finished() has returned. The tracer is not owned by the library, and must be
+    removed using removeTracer() before it is deleted. Spans that begin while there are no tracers are not reported.
+    
+    Example usage:
+    
+    \code
+    class LogTracer : public QSoundCloud::Tracer
+    {
+    
+    public:
+        void beginSpan(const QSoundCloud::TraceSpan &span) {
+            qDebug() << "begin" << span.id() << span.parentId() << span.name() << span.url();
+        }
+        
+        void endSpan(const QSoundCloud::TraceSpan &span) {
+            qDebug() << "end" << span.id() << span.duration() << span.statusCode() << span.error();
+        }
+    };
+    
+    LogTracer tracer;
+    QSoundCloud::Tracer::addTracer(&tracer);
+    \endcode
+    
+    \sa RequestObserver
+*/
+Tracer::~Tracer() {}
+
+/*!
+    \fn void Tracer::beginSpan(const TraceSpan &span)
+    \brief Called when \a span begins.
+*/
+
+/*!
+    \fn void Tracer::endSpan(const TraceSpan &span)
+    \brief Called when \a span ends.
+*/
+
+/*!
+    \brief Adds \a tracer to the tracers notified of every span.
+*/
+void Tracer::addTracer(Tracer *tracer) {
+    Tracers *d = globalTracers();
+    QMutexLocker locker(&d->mutex);
+    
+    if (!d->tracers.contains(tracer)) {
+        d->tracers << tracer;
+    }
+}
+
+/*!
+    \brief Removes \a tracer from the tracers notified of every span.
+*/
+void Tracer::removeTracer(Tracer *tracer) {
+    Tracers *d = globalTracers();
+    QMutexLocker locker(&d->mutex);
+    d->tracers.removeOne(tracer);
+}
+
+void Tracer::begin(TraceSpan *span) {
+    Tracers *d = globalTracers();
+    QMutexLocker locker(&d->mutex);
+    
+    if (d->tracers.isEmpty()) {
+        return;
+    }
+    
+    span->setId(++d->nextId);
+    
+    if (span->parentId() == 0) {
+        span->setTraceId(span->id());
+    }
+    
+    if (span->startTime() == 0) {
+        span->setStartTime(QDateTime::currentMSecsSinceEpoch());
+    }
+    
+    const QList<Tracer*> tracers = d->tracers;
+    locker.unlock();
+    
+    foreach (Tracer *tracer, tracers) {
+        tracer->beginSpan(*span);
+    }
+}
+
+void Tracer::end(TraceSpan *span) {
+    // The span was not begun, because there were no tracers.
+    if (span->id() == 0) {
+        return;
+    }
+    
+    span->setEndTime(QDateTime::currentMSecsSinceEpoch());
+    Tracers *d = globalTracers();
+    QMutexLocker locker(&d->mutex);
+    const QList<Tracer*> tracers = d->tracers;
+    locker.unlock();
+    
+    foreach (Tracer *tracer, tracers) {
+        tracer->endSpan(*span);
+    }
+    
+    *span = TraceSpan();
+}
+
+}
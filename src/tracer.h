@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QSOUNDCLOUD_TRACER_H
+#define QSOUNDCLOUD_TRACER_H
+
+#include "tracespan.h"
+
+namespace QSoundCloud {
+
+class QSOUNDCLOUDSHARED_EXPORT Tracer
+{
+
+public:
+    virtual ~Tracer();
+    
+    virtual void beginSpan(const TraceSpan &span) = 0;
+    virtual void endSpan(const TraceSpan &span) = 0;
+    
+    static void addTracer(Tracer *tracer);
+    static void removeTracer(Tracer *tracer);
+
+private:
+    static void begin(TraceSpan *span);
+    static void end(TraceSpan *span);
+    
+    friend class RequestPrivate;
+};
+
+}
+
+#endif // QSOUNDCLOUD_TRACER_H
@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tracespan.h"
+
+namespace QSoundCloud {
+
+/*!
+    \class TraceSpan
+    \brief Describes a span of time during which the library performed an operation.
+    
+    \ingroup requests
+    
+    Each Request operation, such as a GET request for a resource, is reported to a Tracer as a span of the kind
+    OperationSpan. Each HTTP request made during the operation, including those made for redirects, retries and
+    access token refreshes, is reported as a span of the kind HttpSpan, whose parentId() is the id() of the
+    operation span. All spans of an operation have the same traceId(), which is the id() of the operation span.
+    
+    For example, StreamsRequest::get() is reported as an operation span, with child spans for the GET request for
+    the track, any redirects, and the HEAD requests for the download and stream URLs.
+    
+    Times are in milliseconds since the epoch, and URLs do not include the client id or access token.
+    
+    \sa Tracer
+*/
+
+/*!
+    \enum TraceSpan::Kind
+    
+    The kinds of span are:
+    
+    <table>
+        <tr>
+            <th>Value</th>
+            <th>Description</th>
+        </tr>
+        <tr>
+            <td>OperationSpan</td>
+            <td>A Request operation, from when it was started until Request::finished() was emitted.</td>
+        </tr>
+        <tr>
+            <td>HttpSpan</td>
+            <td>An HTTP request made during an operation, from when it was made until the response was received.</td>
+        </tr>
+    </table>
+*/
+TraceSpan::TraceSpan() :
+    m_id(0),
+    m_parentId(0),
+    m_traceId(0),
+    m_kind(OperationSpan),
+    m_startTime(0),
+    m_endTime(0),
+    m_statusCode(0),
+    m_status(Request::Null),
+    m_error(Request::NoError)
+{
+}
+
+/*!
+    \brief Returns the id of the span, which is unique within the process.
+*/
+quint64 TraceSpan::id() const {
+    return m_id;
+}
+
+/*!
+    \brief Sets the id of the span to \a id.
+*/
+void TraceSpan::setId(quint64 id) {
+    m_id = id;
+}
+
+/*!
+    \brief Returns the id of the span of which this span is a part, or 0 if it has no parent.
+*/
+quint64 TraceSpan::parentId() const {
+    return m_parentId;
+}
+
+/*!
+    \brief Sets the id of the span of which this span is a part to \a id.
+*/
+void TraceSpan::setParentId(quint64 id) {
+    m_parentId = id;
+}
+
+/*!
+    \brief Returns the id of the operation span at the root of the trace to which this span belongs.
+*/
+quint64 TraceSpan::traceId() const {
+    return m_traceId;
+}
+
+/*!
+    \brief Sets the id of the operation span at the root of the trace to which this span belongs to \a id.
+*/
+void TraceSpan::setTraceId(quint64 id) {
+    m_traceId = id;
+}
+
+/*!
+    \brief Returns the kind of the span.
+*/
+TraceSpan::Kind TraceSpan::kind() const {
+    return m_kind;
+}
+
+/*!
+    \brief Sets the kind of the span to \a kind.
+*/
+void TraceSpan::setKind(Kind kind) {
+    m_kind = kind;
+}
+
+/*!
+    \brief Returns the name of the span.
+    
+    The name of an operation span is the class of the request, such as "StreamsRequest", and the name of an HTTP
+    span is "HTTP" followed by the method, such as "HTTP HEAD".
+*/
+QString TraceSpan::name() const {
+    return m_name;
+}
+
+/*!
+    \brief Sets the name of the span to \a name.
+*/
+void TraceSpan::setName(const QString &name) {
+    m_name = name;
+}
+
+/*!
+    \brief Returns the HTTP method of the operation or HTTP request, such as "GET".
+*/
+QString TraceSpan::method() const {
+    return m_method;
+}
+
+/*!
+    \brief Sets the HTTP method of the operation or HTTP request to \a method.
+*/
+void TraceSpan::setMethod(const QString &method) {
+    m_method = method;
+}
+
+/*!
+    \brief Returns the URL of the operation or HTTP request.
+*/
+QUrl TraceSpan::url() const {
+    return m_url;
+}
+
+/*!
+    \brief Sets the URL of the operation or HTTP request to \a url.
+*/
+void TraceSpan::setUrl(const QUrl &url) {
+    m_url = url;
+}
+
+/*!
+    \brief Returns the time at which the span started.
+*/
+qint64 TraceSpan::startTime() const {
+    return m_startTime;
+}
+
+/*!
+    \brief Sets the time at which the span started to \a time.
+*/
+void TraceSpan::setStartTime(qint64 time) {
+    m_startTime = time;
+}
+
+/*!
+    \brief Returns the time at which the span ended, or 0 if it has not ended.
+*/
+qint64 TraceSpan::endTime() const {
+    return m_endTime;
+}
+
+/*!
+    \brief Sets the time at which the span ended to \a time.
+*/
+void TraceSpan::setEndTime(qint64 time) {
+    m_endTime = time;
+}
+
+/*!
+    \brief Returns the duration of the span in milliseconds, or -1 if it has not ended.
+*/
+qint64 TraceSpan::duration() const {
+    return (m_startTime > 0) && (m_endTime > 0) ? m_endTime - m_startTime : -1;
+}
+
+/*!
+    \brief Returns the HTTP status code of the response, or 0 if there was none.
+    
+    This is set only for HTTP spans.
+*/
+int TraceSpan::statusCode() const {
+    return m_statusCode;
+}
+
+/*!
+    \brief Sets the HTTP status code of the response to \a code.
+*/
+void TraceSpan::setStatusCode(int code) {
+    m_statusCode = code;
+}
+
+/*!
+    \brief Returns the status of the request when the span ended.
+    
+    This is set only for operation spans.
+*/
+Request::Status TraceSpan::status() const {
+    return m_status;
+}
+
+/*!
+    \brief Sets the status of the request when the span ended to \a status.
+*/
+void TraceSpan::setStatus(Request::Status status) {
+    m_status = status;
+}
+
+/*!
+    \brief Returns the error of the operation or HTTP request.
+*/
+Request::Error TraceSpan::error() const {
+    return m_error;
+}
+
+/*!
+    \brief Sets the error of the operation or HTTP request to \a error.
+*/
+void TraceSpan::setError(Request::Error error) {
+    m_error = error;
+}
+
+/*!
+    \brief Returns a description of the error of the operation or HTTP request.
+*/
+QString TraceSpan::errorString() const {
+    return m_errorString;
+}
+
+/*!
+    \brief Sets the description of the error of the operation or HTTP request to \a errorString.
+*/
+void TraceSpan::setErrorString(const QString &errorString) {
+    m_errorString = errorString;
+}
+
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QSOUNDCLOUD_TRACESPAN_H
+#define QSOUNDCLOUD_TRACESPAN_H
+
+#include "request.h"
+#include <QUrl>
+
+namespace QSoundCloud {
+
+class QSOUNDCLOUDSHARED_EXPORT TraceSpan
+{
+
+public:
+    enum Kind {
+        OperationSpan = 0,
+        HttpSpan
+    };
+    
+    TraceSpan();
+    
+    quint64 id() const;
+    void setId(quint64 id);
+    
+    quint64 parentId() const;
+    void setParentId(quint64 id);
+    
+    quint64 traceId() const;
+    void setTraceId(quint64 id);
+    
+    Kind kind() const;
+    void setKind(Kind kind);
+    
+    QString name() const;
+    void setName(const QString &name);
+    
+    QString method() const;
+    void setMethod(const QString &method);
+    
+    QUrl url() const;
+    void setUrl(const QUrl &url);
+    
+    qint64 startTime() const;
+    void setStartTime(qint64 time);
+    
+    qint64 endTime() const;
+    void setEndTime(qint64 time);
+    
+    qint64 duration() const;
+    
+    int statusCode() const;
+    void setStatusCode(int code);
+    
+    Request::Status status() const;
+    void setStatus(Request::Status status);
+    
+    Request::Error error() const;
+    void setError(Request::Error error);
+    
+    QString errorString() const;
+    void setErrorString(const QString &errorString);
+
+private:
+    quint64 m_id;
+    quint64 m_parentId;
+    quint64 m_traceId;
+    
+    Kind m_kind;
+    
+    QString m_name;
+    QString m_method;
+    QUrl m_url;
+    
+    qint64 m_startTime;
+    qint64 m_endTime;
+    
+    int m_statusCode;
+    
+    Request::Status m_status;
+    Request::Error m_error;
+    QString m_errorString;
+};
+
+}
+
+#endif // QSOUNDCLOUD_TRACESPAN_H
@@ -15,6 +15,7 @@
  */
 
 #include "webview.h"
+#include "tokenstore.h"
 #include <QApplication>
 
 int main(int argc, char *argv[]) {
@@ -22,6 +23,9 @@ int main(int argc, char *argv[]) {
     app.setOrganizationName("QSoundCloud");
     app.setApplicationName("QSoundCloud");
     
+    // The access token obtained is written to the Authentication group, for use by the other tests.
+    QSoundCloud::TokenStore::setDefaultStore(new QSoundCloud::SettingsTokenStore);
+    
     WebView view;
     view.resize(800, 600);
     view.show();
@@ -0,0 +1,11 @@
+TEMPLATE = app
+TARGET = client-get
+INSTALLS += target
+
+INCLUDEPATH += ../../../src
+LIBS += -L../../../lib -lqsoundcloud
+SOURCES += main.cpp
+
+unix {
+    target.path = /opt/qsoundcloud/bin
+}
@@ -16,9 +16,9 @@
 
 #include "resourcesrequest.h"
 #include "json.h"
+#include "tokenstore.h"
 #include <QCoreApplication>
 #include <QStringList>
-#include <QSettings>
 #include <QDebug>
 
 int main(int argc, char *argv[]) {
@@ -38,13 +38,9 @@ int main(int argc, char *argv[]) {
     QString resourcePath = args.takeFirst();
     QVariantMap filters = args.isEmpty() ? QVariantMap() : QtJson::Json::parse(args.takeFirst()).toMap();
     
-    QSettings settings;
-
+    QSoundCloud::TokenStore::setDefaultStore(new QSoundCloud::SettingsTokenStore);
+    
     QSoundCloud::ResourcesRequest request;
-    request.setClientId(settings.value("Authentication/clientId").toString());
-    request.setClientSecret(settings.value("Authentication/clientSecret").toString());
-    request.setAccessToken(settings.value("Authentication/accessToken").toString());
-    request.setRefreshToken(settings.value("Authentication/refreshToken").toString());
     request.get(resourcePath, filters);
     QObject::connect(&request, SIGNAL(finished()), &app, SLOT(quit()));
 
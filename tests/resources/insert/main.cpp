@@ -16,9 +16,9 @@
 
 #include "resourcesrequest.h"
 #include "json.h"
+#include "tokenstore.h"
 #include <QCoreApplication>
 #include <QStringList>
-#include <QSettings>
 #include <QDebug>
 
 int main(int argc, char *argv[]) {
@@ -35,13 +35,9 @@ int main(int argc, char *argv[]) {
     
     args.removeFirst();
 
-    QSettings settings;
-
+    QSoundCloud::TokenStore::setDefaultStore(new QSoundCloud::SettingsTokenStore);
+    
     QSoundCloud::ResourcesRequest request;
-    request.setClientId(settings.value("Authentication/clientId").toString());
-    request.setClientSecret(settings.value("Authentication/clientSecret").toString());
-    request.setAccessToken(settings.value("Authentication/accessToken").toString());
-    request.setRefreshToken(settings.value("Authentication/refreshToken").toString());
     
     if (args.size() > 1) {
         QVariantMap resource = QtJson::Json::parse(args.takeFirst()).toMap();
@@ -3,4 +3,5 @@ SUBDIRS += \
     del \
     get \
     insert \
+    resume \
     update
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "resourcesmodel.h"
+#include "tokenstore.h"
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QSet>
+#include <QStringList>
+#include <QDebug>
+
+static bool waitForModel(QSoundCloud::ResourcesModel *model) {
+    if (model->status() == QSoundCloud::ResourcesRequest::Loading) {
+        QEventLoop loop;
+        QObject::connect(model, SIGNAL(statusChanged(QSoundCloud::ResourcesRequest::Status)), &loop, SLOT(quit()));
+        loop.exec();
+    }
+    
+    if (model->status() != QSoundCloud::ResourcesRequest::Ready) {
+        qWarning() << model->errorString();
+        return false;
+    }
+    
+    return true;
+}
+
+// Adds the ids of the rows from first to the end of the model to ids, and returns false if any was already there.
+static bool addIds(QSoundCloud::ResourcesModel *model, int first, QSet<QString> *ids) {
+    for (int i = first; i < model->rowCount(); i++) {
+        const QString id = model->get(i).value("id").toString();
+        
+        if (ids->contains(id)) {
+            qWarning() << "Resource" << id << "was retrieved more than once";
+            return false;
+        }
+        
+        ids->insert(id);
+    }
+    
+    return true;
+}
+
+// Retrieves the first page of a cursor query, resumes the query from its cursor in another model, and then fetches
+// one more page. Every resource should be retrieved only once, so the resumed query must still use the cursor.
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setOrganizationName("QSoundCloud");
+    app.setApplicationName("QSoundCloud");
+    
+    QStringList args = app.arguments();
+    
+    if (args.size() < 2) {
+        qWarning() << "Usage: resources-resume RESOURCEPATH [LIMIT]";
+        return 0;
+    }
+    
+    args.removeFirst();
+    
+    QString resourcePath = args.takeFirst();
+    QVariantMap filters;
+    filters["linked_partitioning"] = 1;
+    filters["limit"] = args.isEmpty() ? 10 : args.takeFirst().toInt();
+    
+    QSoundCloud::TokenStore::setDefaultStore(new QSoundCloud::SettingsTokenStore);
+    
+    QSet<QString> ids;
+    QSoundCloud::ResourcesModel model;
+    model.get(resourcePath, filters);
+    
+    if ((!waitForModel(&model)) || (!addIds(&model, 0, &ids))) {
+        return 1;
+    }
+    
+    const QString cursor = model.cursor();
+    
+    if (cursor.isEmpty()) {
+        qWarning() << "There is only one page, so the query cannot be resumed";
+        return 1;
+    }
+    
+    QSoundCloud::ResourcesModel resumed;
+    resumed.resume(resourcePath, cursor);
+    
+    if ((!waitForModel(&resumed)) || (!addIds(&resumed, 0, &ids))) {
+        return 1;
+    }
+    
+    if (!resumed.canFetchMore()) {
+        qDebug() << "The resumed query has no more pages";
+        return 0;
+    }
+    
+    const int count = resumed.rowCount();
+    resumed.fetchMore();
+    
+    if ((!waitForModel(&resumed)) || (!addIds(&resumed, count, &ids))) {
+        return 1;
+    }
+    
+    if (resumed.rowCount() == count) {
+        qWarning() << "No resources were retrieved after resuming";
+        return 1;
+    }
+    
+    qDebug() << "Retrieved" << ids.size() << "resources, each once";
+    return 0;
+}
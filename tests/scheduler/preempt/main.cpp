@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2015 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "requestscheduler.h"
+#include "resourcesrequest.h"
+#include "tokenstore.h"
+#include <QCoreApplication>
+#include <QStringList>
+#include <QDebug>
+
+// Makes several background requests and then an interactive one, with a limit of one request in total. The
+// interactive request should preempt the background request in progress, and finish before any background request.
+class Recorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Recorder(int count) :
+        QObject(),
+        remaining(count)
+    {
+    }
+    
+    QList<QSoundCloud::Request*> order;
+
+public Q_SLOTS:
+    void onFinished() {
+        QSoundCloud::Request *request = qobject_cast<QSoundCloud::Request*>(sender());
+        qDebug() << "Finished" << request->priority() << request->status();
+        order << request;
+        
+        if (--remaining == 0) {
+            QCoreApplication::quit();
+        }
+    }
+
+private:
+    int remaining;
+};
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setOrganizationName("QSoundCloud");
+    app.setApplicationName("QSoundCloud");
+    
+    QStringList args = app.arguments();
+    
+    if (args.size() < 2) {
+        qWarning() << "Usage: scheduler-preempt RESOURCEPATH";
+        return 0;
+    }
+    
+    args.removeFirst();
+    
+    QString resourcePath = args.takeFirst();
+    
+    QSoundCloud::TokenStore::setDefaultStore(new QSoundCloud::SettingsTokenStore);
+    QSoundCloud::RequestScheduler::setMaximumTotalActiveRequests(1);
+    
+    const int backgroundCount = 3;
+    Recorder recorder(backgroundCount + 1);
+    
+    for (int i = 0; i < backgroundCount; i++) {
+        QSoundCloud::ResourcesRequest *request = new QSoundCloud::ResourcesRequest(&app);
+        request->setPriority(QSoundCloud::Request::BackgroundPriority);
+        QObject::connect(request, SIGNAL(finished()), &recorder, SLOT(onFinished()));
+        request->get(resourcePath);
+    }
+    
+    qDebug() << "Background requests active:"
+             << QSoundCloud::RequestScheduler::activeRequests(QSoundCloud::Request::BackgroundPriority)
+             << "queued:" << QSoundCloud::RequestScheduler::queuedRequests(QSoundCloud::Request::BackgroundPriority);
+    
+    QSoundCloud::ResourcesRequest *interactive = new QSoundCloud::ResourcesRequest(&app);
+    interactive->setPriority(QSoundCloud::Request::InteractivePriority);
+    QObject::connect(interactive, SIGNAL(finished()), &recorder, SLOT(onFinished()));
+    interactive->get(resourcePath);
+    
+    app.exec();
+    
+    if ((recorder.order.isEmpty()) || (recorder.order.first() != interactive)) {
+        qWarning() << "The interactive request did not finish first";
+        return 1;
+    }
+    
+    qDebug() << "The interactive request finished first";
+    return 0;
+}
+
+#include "main.moc"
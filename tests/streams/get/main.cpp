@@ -15,9 +15,9 @@
  */
 
 #include "streamsrequest.h"
+#include "tokenstore.h"
 #include <QCoreApplication>
 #include <QStringList>
-#include <QSettings>
 #include <QDebug>
 
 int main(int argc, char *argv[]) {
@@ -34,13 +34,9 @@ int main(int argc, char *argv[]) {
     
     args.removeFirst();
     
-    QSettings settings;
-
+    QSoundCloud::TokenStore::setDefaultStore(new QSoundCloud::SettingsTokenStore);
+    
     QSoundCloud::StreamsRequest request;
-    request.setClientId(settings.value("Authentication/clientId").toString());
-    request.setClientSecret(settings.value("Authentication/clientSecret").toString());
-    request.setAccessToken(settings.value("Authentication/accessToken").toString());
-    request.setRefreshToken(settings.value("Authentication/refreshToken").toString());
     request.get(args.takeFirst());
     QObject::connect(&request, SIGNAL(finished()), &app, SLOT(quit()));
 
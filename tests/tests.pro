@@ -1,5 +1,7 @@
 TEMPLATE = subdirs
 SUBDIRS += \
     authentication \
+    client \
     resources \
+    scheduler \
     streams